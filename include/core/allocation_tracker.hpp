@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace capvision {
+namespace core {
+
+// Heap allocation counts per pipeline stage, for keeping the warmed-up frame
+// loop allocation-free. Only active in builds with CAPVISION_TRACK_ALLOCATIONS
+// (the CMake option of the same name). Those builds replace the global
+// operator new and install a counting cv::MatAllocator, so both C++ objects
+// and cv::Mat buffers are counted. Allocations made directly with malloc,
+// for example by Qt or OpenGL drivers, are not seen. Without the option,
+// Scope compiles to nothing and every count is zero.
+//
+// Each thread counts against the stage of its innermost Scope. Allocations
+// outside any Scope count against "other". Pool workers have no Scope of
+// their own, so their allocations land in "other" too.
+class AllocationTracker {
+public:
+    struct Counts {
+        uint64_t allocations{0};
+        uint64_t bytes{0};
+    };
+
+    static constexpr size_t kMaxStages = 16;
+
+#ifdef CAPVISION_TRACK_ALLOCATIONS
+    static constexpr bool kEnabled = true;
+
+    // Attributes this thread's allocations to stage until destroyed. The
+    // name must outlive the process (a string literal).
+    class Scope {
+    public:
+        explicit Scope(const char* stage);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        int previous_;
+    };
+#else
+    static constexpr bool kEnabled = false;
+
+    class Scope {
+    public:
+        explicit Scope(const char*) {}
+    };
+#endif
+
+    // Counts since the process started, per stage that has seen a Scope
+    static std::vector<std::pair<std::string, Counts>> snapshot();
+    static Counts total();
+
+    // Publish the allocations of each stage since the previous call as
+    // alloc.<stage>, plus alloc.total; called once per frame, these are the
+    // per-frame counts. Does nothing when tracking is compiled out.
+    static void publish();
+};
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace capvision {
+namespace core {
+
+enum class PixelFormat {
+    BGR,    // CV_8UC3
+    YUYV,   // Packed 4:2:2, CV_8UC2 (Y0 U Y1 V)
+    MJPEG   // One compressed JPEG, 1xN CV_8UC1
+};
+
+struct CapturedFrame {
+    cv::Mat image;               // Pixels in `format`; may point into driver memory
+    PixelFormat format{PixelFormat::BGR};
+    int64_t timestamp_us{0};     // Capture time on the steady (monotonic) clock
+    uint64_t sequence{0};        // Increasing frame counter from the source
+};
+
+// A source of camera frames. Backends deliver the freshest frame available
+// and may hand out memory they own: `image` stays valid only until the next
+// read() or close().
+class CaptureSource {
+public:
+    virtual ~CaptureSource() = default;
+
+    virtual bool open() = 0;
+    virtual bool isOpened() const = 0;
+    virtual void close() = 0;
+
+    // Block until a frame newer than the previous one arrives
+    virtual bool read(CapturedFrame& frame) = 0;
+};
+
+// cv::VideoCapture camera, for platforms without a native backend
+class OpenCvCaptureSource : public CaptureSource {
+public:
+    explicit OpenCvCaptureSource(int deviceIndex);
+    ~OpenCvCaptureSource() override;
+
+    bool open() override;
+    bool isOpened() const override;
+    void close() override;
+    bool read(CapturedFrame& frame) override;
+
+private:
+    int device_index_;
+    cv::VideoCapture capture_;
+    uint64_t sequence_{0};
+};
+
+// Best low-latency backend for the camera at `deviceIndex` on this platform,
+// already opened; check isOpened() for failure
+std::unique_ptr<CaptureSource> createCameraSource(int deviceIndex);
+
+// Current time on the clock used for capture timestamps
+int64_t steadyNowMicros();
+
+// Convert any captured format to BGR. BGR input is shared, not copied, and
+// `bgr` reuses its buffer across calls.
+bool convertToBgr(const CapturedFrame& frame, cv::Mat& bgr);
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "flat_shape_model.hpp"
+#include <dlib/image_processing.h>
+#include <algorithm>
+#include <chrono>
+#include <istream>
+#include <type_traits>
+#include <vector>
+
+namespace capvision {
+namespace core {
+
+// Drop-in replacement for dlib::shape_predictor that reads the same model
+// files but can stop the cascade early. The full model refines the mean
+// face through every level of regression forests; most of the correction
+// comes from the first levels, so running fewer levels (or fewer trees per
+// level) trades landmark precision for time. With the default Quality the
+// result is identical to dlib's.
+//
+// After flatten() 8-bit images are evaluated from a packed copy of the
+// forests (FlatShapeModel) instead of dlib's per-tree layout.
+//
+// Inference is const: everything a call writes lives in the caller's
+// Workspace, so one loaded predictor can serve any number of threads.
+class CascadeShapePredictor {
+public:
+    // Per-caller state, reused across calls
+    struct Workspace {
+        std::vector<float> feature_pixel_values;
+        FlatShapeModel::Scratch flat;
+        double level_cost_ms{0.0};   // Running average cost of one full level
+    };
+
+    struct Quality {
+        unsigned long cascade_depth{0};     // Cascade levels to run; 0 = all
+        unsigned long trees_per_level{0};   // Trees evaluated per level; 0 = all
+
+        // Preset from 0 (fastest) to kMaxQualityLevel (full cascade)
+        static Quality level(int qualityLevel, const CascadeShapePredictor& predictor);
+    };
+
+    static constexpr int kMaxQualityLevel = 4;
+
+    CascadeShapePredictor() = default;
+
+    unsigned long numLevels() const { return num_levels_; }
+    unsigned long treesPerLevel() const { return trees_per_level_; }
+    unsigned long numParts() const { return static_cast<unsigned long>(initial_shape_.size() / 2); }
+
+    template <typename image_type>
+    dlib::full_object_detection operator()(const image_type& img, const dlib::rectangle& rect,
+                                           Workspace& workspace, const Quality& quality = Quality{}) const;
+
+    // Warm start: begin from `previous` (last frame's landmarks, carried
+    // into `rect` by the similarity transform between the two face boxes)
+    // instead of the mean face, and run only levels from startLevel on; the
+    // coarse early levels mostly redo the fit a tracked face already has.
+    // quality.cascade_depth still bounds the last level; at least one level
+    // runs.
+    template <typename image_type>
+    dlib::full_object_detection refine(const image_type& img, const dlib::rectangle& rect,
+                                       const dlib::full_object_detection& previous,
+                                       unsigned long startLevel, Workspace& workspace,
+                                       const Quality& quality = Quality{}) const;
+
+    // Deepest cascade whose cost measured in workspace fits in budgetMs (at
+    // least one level); the full cascade until a cost has been measured
+    Quality qualityForBudget(double budgetMs, const Workspace& workspace) const;
+
+    // Pack the forests into the flat layout; with releaseNested the dlib
+    // trees are freed and other image types are converted to 8-bit first.
+    // False (and nothing changes) if the model cannot be packed.
+    bool flatten(bool releaseNested = true);
+    bool flattened() const { return !flat_.empty(); }
+
+    // Resident size of the tree data in whichever layouts are loaded
+    size_t memoryBytes() const;
+
+    friend void deserialize(CascadeShapePredictor& item, std::istream& in);
+
+private:
+    // Levels [firstLevel, depth) from current_shape, normalized to rect
+    template <typename image_type>
+    dlib::full_object_detection predict(const image_type& img, const dlib::rectangle& rect,
+                                        dlib::matrix<float, 0, 1> current_shape,
+                                        unsigned long firstLevel, Workspace& workspace,
+                                        const Quality& quality) const;
+
+    void recordCost(Workspace& workspace, double ms, unsigned long levels, unsigned long trees) const;
+
+    dlib::matrix<float, 0, 1> initial_shape_;
+    std::vector<std::vector<dlib::impl::regression_tree>> forests_;
+    std::vector<std::vector<unsigned long>> anchor_idx_;
+    std::vector<std::vector<dlib::vector<float, 2>>> deltas_;
+
+    unsigned long num_levels_{0};
+    unsigned long trees_per_level_{0};
+    FlatShapeModel flat_;
+};
+
+template <typename image_type>
+dlib::full_object_detection CascadeShapePredictor::operator()(const image_type& img,
+                                                              const dlib::rectangle& rect,
+                                                              Workspace& workspace,
+                                                              const Quality& quality) const {
+    return predict(img, rect, initial_shape_, 0, workspace, quality);
+}
+
+template <typename image_type>
+dlib::full_object_detection CascadeShapePredictor::refine(const image_type& img,
+                                                          const dlib::rectangle& rect,
+                                                          const dlib::full_object_detection& previous,
+                                                          unsigned long startLevel,
+                                                          Workspace& workspace,
+                                                          const Quality& quality) const {
+    if (previous.num_parts() != numParts() || numLevels() == 0) {
+        return predict(img, rect, initial_shape_, 0, workspace, quality);
+    }
+
+    // Normalized to the previous box, the shape lands in the new box as is
+    const dlib::point_transform_affine to_unit = dlib::impl::normalizing_tform(previous.get_rect());
+    dlib::matrix<float, 0, 1> start_shape(initial_shape_.size());
+    for (unsigned long i = 0; i < previous.num_parts(); ++i) {
+        const dlib::vector<double, 2> p = to_unit(previous.part(i));
+        start_shape(2 * i) = static_cast<float>(p.x());
+        start_shape(2 * i + 1) = static_cast<float>(p.y());
+    }
+    return predict(img, rect, start_shape, std::min(startLevel, numLevels() - 1), workspace, quality);
+}
+
+template <typename image_type>
+dlib::full_object_detection CascadeShapePredictor::predict(const image_type& img,
+                                                           const dlib::rectangle& rect,
+                                                           dlib::matrix<float, 0, 1> current_shape,
+                                                           unsigned long firstLevel,
+                                                           Workspace& workspace,
+                                                           const Quality& quality) const {
+    const auto start = std::chrono::steady_clock::now();
+
+    unsigned long levels = quality.cascade_depth == 0
+        ? numLevels() : std::min(quality.cascade_depth, numLevels());
+    levels = std::max(levels, std::min(firstLevel + 1, numLevels()));
+
+    const unsigned long trees = quality.trees_per_level == 0
+        ? treesPerLevel() : std::min(quality.trees_per_level, treesPerLevel());
+
+    bool evaluated = false;
+    using pixel_type = typename dlib::image_traits<image_type>::pixel_type;
+    if constexpr (std::is_same<pixel_type, unsigned char>::value) {
+        if (!flat_.empty()) {
+            const dlib::const_image_view<image_type> view(img);
+            flat_.evaluate(static_cast<const unsigned char*>(dlib::image_data(img)), view.nr(), view.nc(),
+                           dlib::width_step(img), rect, firstLevel, levels, trees, current_shape,
+                           workspace.flat);
+            evaluated = true;
+        }
+    }
+
+    if (!evaluated && forests_.empty() && !flat_.empty()) {
+        // Nested trees released: sample from an 8-bit copy
+        dlib::array2d<unsigned char> gray;
+        dlib::assign_image(gray, img);
+        flat_.evaluate(static_cast<const unsigned char*>(dlib::image_data(gray)), gray.nr(), gray.nc(),
+                       dlib::width_step(gray), rect, firstLevel, levels, trees, current_shape,
+                       workspace.flat);
+        evaluated = true;
+    }
+
+    if (!evaluated) {
+        // Same evaluation as dlib::shape_predictor::operator(), truncated
+        for (unsigned long iter = firstLevel; iter < levels; ++iter) {
+            dlib::impl::extract_feature_pixel_values(img, rect, current_shape, initial_shape_,
+                                                     anchor_idx_[iter], deltas_[iter],
+                                                     workspace.feature_pixel_values);
+            const auto& forest = forests_[iter];
+            for (unsigned long i = 0; i < trees; ++i) {
+                current_shape += forest[i](workspace.feature_pixel_values);
+            }
+        }
+    }
+
+    const dlib::point_transform_affine tform_to_img = dlib::impl::unnormalizing_tform(rect);
+    std::vector<dlib::point> parts(current_shape.size() / 2);
+    for (unsigned long i = 0; i < parts.size(); ++i) {
+        parts[i] = tform_to_img(dlib::impl::location(current_shape, i));
+    }
+
+    recordCost(workspace, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+               levels - firstLevel, trees);
+    return dlib::full_object_detection(rect, parts);
+}
+
+} // namespace core
+} // namespace capvision
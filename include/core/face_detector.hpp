@@ -4,46 +4,155 @@
 #include <dlib/image_processing.h>
 #include <dlib/image_processing/frontal_face_detector.h>
 #include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include "cascade_shape_predictor.hpp"
+#include "face_models.hpp"
+#include "gray_pyramid.hpp"
+#include "head_pose.hpp"
+#include "landmark_array.hpp"
+#include "parallel_face_scanner.hpp"
+#include "thread_pool.hpp"
 
 namespace capvision {
 namespace core {
 
 class FaceDetector {
 public:
+    // Fixed-size members only: copying a result, e.g. to another thread or
+    // to the renderer, never allocates
     struct FaceDetectionResult {
-        std::vector<cv::Point2f> landmarks;  // 68 facial landmarks
-        cv::Mat rotation_matrix;             // 3x3 rotation matrix
+        LandmarkArray landmarks;             // 68 facial landmarks
+        cv::Matx33d rotation_matrix;         // 3x3 rotation matrix; zero without a face
         cv::Vec3d euler_angles;              // Pitch, Yaw, Roll
         cv::Rect face_rect;                  // Face bounding box
+        int track_id{-1};                    // FaceTracker's stable ID; -1 from detectFace
         bool success{false};
     };
 
+    // Wall time of each stage of the last detectFace call; stages that did
+    // not run (no face found) are 0
+    struct StageTimings {
+        double pyramid_ms{0.0};
+        double detection_ms{0.0};
+        double landmarks_ms{0.0};
+        double pose_ms{0.0};
+    };
+
+    // Landmark cascade depth and trees per level (see CascadeShapePredictor)
+    using LandmarkQuality = CascadeShapePredictor::Quality;
+
+    // Temporal landmark mode: while the same face stays in view, the cascade
+    // starts from the previous frame's landmarks and runs only the later
+    // levels. A fresh detection (no previous face, or a box that moved or
+    // resized by more than max_box_change of its width) or every
+    // refresh_interval frames restarts from the mean face.
+    struct WarmStart {
+        bool enabled{false};
+        unsigned long start_level{0};   // First level run when warm; 0 = half the cascade
+        double max_box_change{0.3};
+        int refresh_interval{30};       // 0 = never force a restart
+    };
+
     FaceDetector();
     ~FaceDetector();
 
-    bool initialize();
+    // flatLandmarkModel packs the landmark forests into the flat inference
+    // layout after loading (smaller and faster; landmarks differ by a
+    // fraction of a pixel); false keeps dlib's layout and exact results.
+    // Detectors initialized with the same setting share one loaded copy.
+    bool initialize(bool flatLandmarkModel = true);
+
+    // Use already loaded models, e.g. one copy for a pool of workers
+    bool initialize(std::shared_ptr<const FaceModels> models);
+    const std::shared_ptr<const FaceModels>& models() const { return models_; }
+
+    // frame is BGR (CV_8UC3), packed YUYV (CV_8UC2) or gray (CV_8UC1); only
+    // its luma is used
     FaceDetectionResult detectFace(const cv::Mat& frame);
 
+    // Same, with the landmark cascade limited to `quality` for this call only
+    FaceDetectionResult detectFace(const cv::Mat& frame, const LandmarkQuality& quality);
+
+    // Quality used by detectFace(frame); the full cascade by default
+    void setLandmarkQuality(const LandmarkQuality& quality) { landmark_quality_ = quality; }
+
+    // Preset from 0 (fastest) to CascadeShapePredictor::kMaxQualityLevel (full)
+    LandmarkQuality landmarkQualityLevel(int level) const;
+    unsigned long landmarkCascadeLevels() const { return models_ ? models_->landmarks.numLevels() : 0; }
+    size_t landmarkModelBytes() const { return models_ ? models_->landmarks.memoryBytes() : 0; }
+
+    void setLandmarkWarmStart(const WarmStart& warmStart);
+    // Next frame starts from the mean face (e.g. after a seek or camera switch)
+    void resetLandmarkWarmStart() { previous_shape_ = dlib::full_object_detection(); }
+
+    // When > 0, detectFace(frame) picks the cascade depth per frame from what
+    // is left of this budget after face detection; 0 restores the fixed quality
+    void setLandmarkBudget(double budgetMs) { landmark_budget_ms_ = budgetMs; }
+
+    // Run the face scan on every Nth frame only; in between the last box is
+    // moved with the landmarks and reused. 1 scans every frame.
+    void setDetectionInterval(int frames) { detection_interval_ = std::max(1, frames); }
+
+    // Leave the finest pyramid levels out of the face scan: cheaper, but
+    // faces smaller than about 80 * 1.2^levels pixels are missed
+    void setDetectionFirstLevel(unsigned long levels) { detection_first_level_ = levels; }
+
+    // Pool used to scan pyramid levels in parallel; nullptr scans them on the
+    // calling thread
+    void setDetectionPool(std::shared_ptr<ThreadPool> pool);
+
+    // Grayscale pyramid of the last frame passed to detectFace, for trackers
+    // and other consumers that want to avoid another conversion
+    const GrayPyramid& pyramid() const { return pyramid_; }
+
+    const StageTimings& lastTimings() const { return timings_; }
+
 private:
-    // DLib's face detector
-    dlib::frontal_face_detector detector_;
+    // quality == nullptr: the configured quality or landmark budget
+    FaceDetectionResult detect(const cv::Mat& frame, const LandmarkQuality* quality);
+
+    // Face detector and landmark model, shared and read-only
+    std::shared_ptr<const FaceModels> models_;
+
+    // Pyramid scanner wrapping models_->face_detector
+    std::shared_ptr<ThreadPool> detection_pool_;
+    std::unique_ptr<ParallelFaceScanner> scanner_;
+
+    // Shared grayscale pyramid read by the detector and the shape predictor
+    GrayPyramid pyramid_;
+    std::vector<dlib::rectangle> faces_;   // This frame's boxes
     
-    // DLib's shape predictor for facial landmarks
-    dlib::shape_predictor shape_predictor_;
+    // This detector's landmark scratch buffers and measured cascade cost
+    CascadeShapePredictor::Workspace landmark_workspace_;
+    LandmarkQuality landmark_quality_;
+    double landmark_budget_ms_{0.0};
+
+    // Detection skipping: box of the last scan, moved by how far the
+    // landmark centroid travelled since
+    int detection_interval_{1};
+    unsigned long detection_first_level_{0};
+    int frames_since_scan_{0};
+    bool has_tracked_face_{false};
+    dlib::rectangle scanned_face_;
+    dlib::dpoint scanned_centroid_;
+    dlib::rectangle tracked_face_;
+
+    // Warm start state: last frame's landmarks, frames since a mean-face fit
+    WarmStart warm_start_;
+    dlib::full_object_detection previous_shape_;
+    int warm_frames_{0};
     
     // Explicit Model path
     const std::string model_path_{"D:/enhanced_projects/cap_vision/resources/models/shape_predictor_68_face_landmarks.dat"};
     
-    // 3D model points for pose estimation
-    std::vector<cv::Point3d> model_points_3d_;
-    
-    // Camera matrix (will be initialized based on image size)
-    cv::Mat camera_matrix_;
-    
-    // Distortion coefficients (assumed to be zero for webcam)
-    cv::Mat dist_coeffs_ = cv::Mat::zeros(4, 1, cv::DataType<double>::type);
+    // solvePnP against a generic 3D face
+    HeadPoseEstimator head_pose_;
     
     bool initialized_{false};
+
+    StageTimings timings_;
 };
 
 } // namespace core
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <dlib/image_processing/frontal_face_detector.h>
+#include <memory>
+#include <string>
+#include "cascade_shape_predictor.hpp"
+
+namespace capvision {
+namespace core {
+
+// The read-only models behind FaceDetector: dlib's HOG face detector and
+// the landmark cascade. Nothing writes to them after loading, so one
+// instance serves any number of detectors on any number of threads; each
+// FaceDetector keeps only its per-thread state (pyramid, scratch buffers,
+// tracking). The landmark model is by far the largest part, about 100 MB in
+// dlib's layout.
+struct FaceModels {
+    dlib::frontal_face_detector face_detector;
+    CascadeShapePredictor landmarks;
+
+    // Load a fresh copy; nullptr if the landmark model cannot be read.
+    // flatLandmarkModel: see FaceDetector::initialize.
+    static std::shared_ptr<const FaceModels> load(const std::string& landmarkPath, bool flatLandmarkModel);
+
+    // The copy already loaded with the same arguments while anything still
+    // holds it, else load(); detectors created independently (server
+    // workers, stream workers) end up on one copy
+    static std::shared_ptr<const FaceModels> shared(const std::string& landmarkPath, bool flatLandmarkModel);
+};
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "face_detector.hpp"
+
+namespace capvision {
+namespace core {
+
+// Wire format of the local face-analysis server. Every message is a fixed
+// header followed by payload_size bytes. Fields are in host byte order: the
+// server only listens on a Unix socket or loopback TCP.
+namespace protocol {
+
+constexpr uint32_t kRequestMagic = 0x51525643;   // "CVRQ"
+constexpr uint32_t kResponseMagic = 0x53525643;  // "CVRS"
+constexpr uint32_t kMaxPayloadSize = 64u << 20;
+
+enum class FrameEncoding : uint16_t {
+    Encoded = 0,  // JPEG/PNG/... bytes; width and height are ignored
+    Gray = 1,     // width * height bytes
+    Bgr = 2,      // width * height * 3 bytes
+    Yuyv = 3      // width * height * 2 bytes
+};
+
+enum class ResultEncoding : uint16_t {
+    Binary = 0,
+    Json = 1
+};
+
+enum class Status : uint16_t {
+    Ok = 0,
+    Busy = 1,              // Queue full; retry later
+    DeadlineExceeded = 2,  // Expired before a worker picked it up
+    BadRequest = 3
+};
+
+#pragma pack(push, 1)
+struct RequestHeader {
+    uint32_t magic{kRequestMagic};
+    uint32_t request_id{0};
+    uint32_t deadline_ms{0};   // Relative to arrival; 0 means no deadline
+    uint16_t frame_encoding{0};
+    uint16_t result_encoding{0};
+    uint32_t width{0};
+    uint32_t height{0};
+    uint32_t payload_size{0};
+};
+
+struct ResponseHeader {
+    uint32_t magic{kResponseMagic};
+    uint32_t request_id{0};
+    uint16_t status{0};
+    uint16_t result_encoding{0};
+    uint32_t payload_size{0};
+};
+#pragma pack(pop)
+
+// Binary result layout:
+//   u8 success, i32 x4 face rect, u16 landmark count, f32 x2 per landmark,
+//   f64 x9 rotation matrix (row major), f64 x3 Euler angles
+void encodeResultBinary(const FaceDetector::FaceDetectionResult& result, std::vector<uint8_t>& out);
+bool decodeResultBinary(const uint8_t* data, size_t size, FaceDetector::FaceDetectionResult& result);
+
+// {"success":true,"face_rect":[x,y,w,h],"landmarks":[[x,y],...],
+//  "rotation_matrix":[...9],"euler_angles":[x,y,z]}
+void encodeResultJson(const FaceDetector::FaceDetectionResult& result, std::vector<uint8_t>& out);
+
+// Blocking helpers for stream sockets; false on error or end of stream
+bool readFully(int fd, void* data, size_t size);
+bool writeFully(int fd, const void* data, size_t size);
+
+} // namespace protocol
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,99 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "face_detector.hpp"
+#include "face_protocol.hpp"
+#include "thread_pool.hpp"
+
+namespace capvision {
+namespace core {
+
+// Local face-analysis server speaking the protocol in face_protocol.hpp over
+// a Unix domain socket or loopback TCP. Requests from all clients land in
+// one bounded queue; a dispatcher gathers them into batches (up to
+// max_batch, or whatever arrived within batch_window) and fans each batch out
+// over the worker pool, decoding and detecting in parallel. A full queue
+// answers Busy right away, and requests whose deadline passed while queued
+// are answered DeadlineExceeded without being processed.
+class FaceServer {
+public:
+    struct Config {
+        std::string unix_socket_path;      // Used when non-empty
+        uint16_t tcp_port{7878};           // Loopback only, when no socket path
+        size_t worker_count{0};            // 0 = one per hardware thread
+        size_t queue_capacity{64};
+        size_t max_batch{16};
+        std::chrono::microseconds batch_window{2000};
+    };
+
+    explicit FaceServer(const Config& config);
+    ~FaceServer();
+
+    FaceServer(const FaceServer&) = delete;
+    FaceServer& operator=(const FaceServer&) = delete;
+
+    bool start();
+    void stop();
+
+private:
+    struct Connection {
+        ~Connection();
+
+        int fd{-1};
+        std::mutex write_mutex;
+        std::thread reader;
+        std::atomic<bool> open{true};
+    };
+
+    struct Request {
+        std::shared_ptr<Connection> connection;
+        protocol::RequestHeader header;
+        std::vector<uint8_t> payload;
+        std::chrono::steady_clock::time_point deadline;
+        bool has_deadline{false};
+    };
+
+    void acceptLoop();
+    void readLoop(std::shared_ptr<Connection> connection);
+    void dispatchLoop();
+    void process(Request& request, FaceDetector& detector);
+    void reply(Connection& connection, uint32_t requestId, protocol::Status status,
+               protocol::ResultEncoding encoding, const std::vector<uint8_t>& payload);
+
+    std::unique_ptr<FaceDetector> acquireDetector();
+    void releaseDetector(std::unique_ptr<FaceDetector> detector);
+
+    Config config_;
+    int listen_fd_{-1};
+    std::atomic<bool> running_{false};
+    std::thread accept_thread_;
+    std::thread dispatch_thread_;
+    std::shared_ptr<ThreadPool> pool_;
+
+    std::mutex connections_mutex_;
+    std::vector<std::shared_ptr<Connection>> connections_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_ready_;
+    std::deque<Request> queue_;
+
+    // One detector per thread that can run a batch item (workers + dispatcher)
+    std::mutex detectors_mutex_;
+    std::vector<std::unique_ptr<FaceDetector>> detectors_;
+};
+
+} // namespace core
+} // namespace capvision
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <dlib/image_processing.h>
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <vector>
+#include "face_detector.hpp"
+#include "face_models.hpp"
+#include "gray_pyramid.hpp"
+#include "head_pose.hpp"
+#include "parallel_face_scanner.hpp"
+#include "thread_pool.hpp"
+
+namespace capvision {
+namespace core {
+
+// Follows every face in view under a stable ID, for a per-frame cost that
+// does not grow with the crowd.
+//
+// The full-frame face scan runs every scan_interval frames. Each scan box
+// is matched to a track by box overlap. A box that overlaps no track has
+// its landmarks fitted and is compared with the landmarks of the remaining
+// tracks, so a face that moved too far for any overlap keeps its ID.
+// Otherwise it starts a new track. A track that no scan matches for more
+// than max_missed_scans scans is dropped.
+//
+// Landmarks and pose are refreshed for only refreshes_per_frame tracks a
+// frame, round robin, longest-waiting first. A refresh warm-starts the
+// cascade from the track's own landmarks inside its box, then runs PnP.
+// Tracks not refreshed are carried along at their landmark velocity with
+// their pose held. Scan frames also fit the faces that are new. Publishes
+// tracker.tracks and tracker.refreshed.
+class FaceTracker {
+public:
+    struct Config {
+        int scan_interval{8};                  // Frames between full-frame scans
+        int refreshes_per_frame{2};            // Tracks fitted per frame
+        size_t max_tracks{16};
+        double min_overlap{0.3};               // Box IoU matching a scan to a track
+        double max_landmark_distance{0.2};     // Mean landmark distance, in face widths
+        int max_missed_scans{1};
+        unsigned long refresh_start_level{0};  // First cascade level of a refresh; 0 = half
+    };
+
+    FaceTracker();
+    explicit FaceTracker(const Config& config);
+
+    bool initialize(std::shared_ptr<const FaceModels> models);
+
+    // Pool the face scan spreads its pyramid levels over; nullptr scans on
+    // the calling thread
+    void setDetectionPool(std::shared_ptr<ThreadPool> pool);
+
+    // Every tracked face in frame (BGR, YUYV or gray), ordered by track_id;
+    // valid until the next call
+    const std::vector<FaceDetector::FaceDetectionResult>& update(const cv::Mat& frame);
+
+    size_t trackCount() const { return tracks_.size(); }
+    // Whether the last update ran the full-frame scan
+    bool scanned() const { return scanned_; }
+    void reset();
+
+private:
+    struct Track {
+        int id{0};
+        FaceDetector::FaceDetectionResult face;
+        dlib::full_object_detection shape;   // Last fitted landmarks
+        dlib::rectangle scanned_box;         // Box of the last matching scan
+        cv::Point2d scanned_centroid;        // Landmark centroid when it matched
+        cv::Point2d centroid;                // Current, propagated
+        cv::Point2d fitted_centroid;         // At the last fit
+        cv::Point2d velocity;                // Pixels per frame
+        int64_t fitted_frame{0};
+        int missed_scans{0};
+        bool needs_fit{true};
+    };
+
+    void scan(const cv::Size& frameSize);
+    void fit(Track& track, const cv::Size& frameSize, bool warm);
+    dlib::rectangle box(const Track& track) const;
+
+    Config config_;
+    std::shared_ptr<const FaceModels> models_;
+    std::shared_ptr<ThreadPool> pool_;
+    std::unique_ptr<ParallelFaceScanner> scanner_;
+    GrayPyramid pyramid_;
+    CascadeShapePredictor::Workspace workspace_;
+    HeadPoseEstimator head_pose_;
+
+    std::vector<Track> tracks_;
+    std::vector<FaceDetector::FaceDetectionResult> results_;
+    std::vector<dlib::rectangle> detections_;
+    int64_t frame_{0};
+    int frames_since_scan_{0};
+    bool scanned_{false};
+    int next_id_{1};
+};
+
+} // namespace core
+} // namespace capvision
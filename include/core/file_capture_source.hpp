@@ -0,0 +1,51 @@
+#pragma once
+
+#include "capture_source.hpp"
+#include <string>
+#include <vector>
+
+namespace capvision {
+namespace core {
+
+// Frames from a video file, a directory of images or a printf-style image
+// pattern such as "clip/frame_%04d.png". Timestamps advance by exactly one
+// frame interval per frame, so runs are reproducible; `paced` additionally
+// sleeps to play back in real time.
+class FileCaptureSource : public CaptureSource {
+public:
+    struct Options {
+        double fps{30.0};    // Used when the file carries no frame rate
+        bool loop{false};
+        bool paced{false};
+    };
+
+    explicit FileCaptureSource(const std::string& path);
+    FileCaptureSource(const std::string& path, const Options& options);
+    ~FileCaptureSource() override;
+
+    bool open() override;
+    bool isOpened() const override { return opened_; }
+    void close() override;
+    bool read(CapturedFrame& frame) override;
+
+    // Frames delivered so far
+    uint64_t frameCount() const { return sequence_; }
+
+private:
+    bool readNext(cv::Mat& image);
+
+    std::string path_;
+    Options options_;
+    bool opened_{false};
+
+    cv::VideoCapture video_;
+    std::vector<std::string> image_files_;   // Empty when reading a video
+    size_t next_image_{0};
+
+    double frame_interval_us_{0.0};
+    int64_t start_us_{0};
+    uint64_t sequence_{0};
+};
+
+} // namespace core
+} // namespace capvision
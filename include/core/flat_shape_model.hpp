@@ -0,0 +1,70 @@
+#pragma once
+
+#include <dlib/image_processing.h>
+#include <cstdint>
+#include <vector>
+
+namespace capvision {
+namespace core {
+
+// The regression forests of a shape predictor repacked for inference.
+// dlib keeps every tree as its own vectors of split features and leaf
+// matrices, so one cascade level walks thousands of small heap blocks. Here
+// each level is a handful of contiguous arrays:
+//   - feature pixels: anchor landmark and offset, one array per field
+//   - splits: pixel-pair indices and thresholds, tree after tree
+//   - leaves: int16 deltas with one scale per level, tree after tree
+// Leaves of a level are summed in int32 and scaled once, which keeps the
+// inner loop integer-only and halves the model next to float leaves.
+// Landmarks match dlib's evaluation to well under a pixel.
+//
+// The model is read-only after build(); evaluate() keeps its working
+// buffers in the caller's Scratch, so threads can share one model.
+class FlatShapeModel {
+public:
+    // Per-caller working buffers, reused across calls
+    struct Scratch {
+        std::vector<float> features;
+        std::vector<int32_t> accumulator;
+    };
+
+    // False if the forests cannot be packed (trees of different shapes)
+    bool build(const dlib::matrix<float, 0, 1>& initialShape,
+               const std::vector<std::vector<dlib::impl::regression_tree>>& forests,
+               const std::vector<std::vector<unsigned long>>& anchorIdx,
+               const std::vector<std::vector<dlib::vector<float, 2>>>& deltas);
+
+    bool empty() const { return levels_.empty(); }
+    size_t memoryBytes() const;
+
+    // Refine `shape` (normalized to the face box) through levels
+    // [firstLevel, endLevel), `trees` trees each, sampling an 8-bit
+    // grayscale image
+    void evaluate(const unsigned char* pixels, long rows, long cols, long stride,
+                  const dlib::rectangle& rect, unsigned long firstLevel, unsigned long endLevel,
+                  unsigned long trees, dlib::matrix<float, 0, 1>& shape, Scratch& scratch) const;
+
+private:
+    struct Level {
+        std::vector<uint16_t> anchor;
+        std::vector<float> delta_x;
+        std::vector<float> delta_y;
+
+        std::vector<uint16_t> split_idx1;
+        std::vector<uint16_t> split_idx2;
+        std::vector<float> split_thresh;
+
+        std::vector<int16_t> leaves;
+        float leaf_scale{0.0f};
+    };
+
+    dlib::matrix<float, 0, 1> initial_shape_;
+    std::vector<Level> levels_;
+    unsigned long trees_per_level_{0};
+    unsigned long splits_per_tree_{0};
+    unsigned long leaves_per_tree_{0};
+    unsigned long shape_size_{0};
+};
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "cascade_shape_predictor.hpp"
+
+namespace capvision {
+namespace core {
+
+// Keeps the live pipeline inside its per-frame time budget by trading
+// quality for time. The caller reports what each frame cost, stage by
+// stage. A few frames over budget in a row step one rung down a fixed
+// ladder: fewer landmark cascade levels first, then face detection on only
+// every other frame, a coarser detection scale and a lighter cap mesh. A
+// longer run with headroom steps back up one rung. The current level and
+// the smoothed stage costs are published to Instrumentation::global().
+class FrameScheduler {
+public:
+    struct Config {
+        double budget_ms{33.3};
+        double recover_fraction{0.7};   // Step up when the smoothed cost is below this share of the budget
+        int overload_frames{3};         // Frames over budget in a row before stepping down
+        int recover_frames{45};         // Frames with headroom in a row before stepping up
+        double smoothing{0.2};          // Weight of the newest frame in the smoothed costs
+    };
+
+    // What the pipeline runs with at one level
+    struct Settings {
+        int landmark_quality{CascadeShapePredictor::kMaxQualityLevel};
+        int detection_interval{1};                // Detect every Nth frame, tracking the box in between
+        unsigned long detection_first_level{0};   // Finest pyramid levels left out of the face scan
+        int cap_lod{0};                           // 0 = full cap mesh
+    };
+
+    // Wall time of one frame, per stage
+    struct FrameCost {
+        double capture_ms{0.0};
+        double detection_ms{0.0};   // Pyramid and face scan
+        double landmarks_ms{0.0};
+        double pose_ms{0.0};
+        double render_ms{0.0};
+
+        double total() const { return capture_ms + detection_ms + landmarks_ms + pose_ms + render_ms; }
+    };
+
+    // Level 0 is full quality, kLevelCount - 1 the cheapest
+    static constexpr int kLevelCount = 6;
+    static Settings settingsFor(int level);
+
+    FrameScheduler();
+    explicit FrameScheduler(const Config& config);
+
+    // Record the frame just finished; true when the level changed and the
+    // pipeline should apply settings()
+    bool endFrame(const FrameCost& cost);
+
+    int level() const { return level_; }
+    const Settings& settings() const { return settings_; }
+    double smoothedCostMs() const { return smoothed_.total(); }
+
+private:
+    void setLevel(int level);
+    void publish() const;
+
+    Config config_;
+    int level_{0};
+    Settings settings_;
+    FrameCost smoothed_;
+    bool has_cost_{false};
+    int over_budget_run_{0};
+    int headroom_run_{0};
+};
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+namespace capvision {
+namespace core {
+
+// Row kernels turning packed 8-bit BGR into 8-bit luma with the integer
+// BT.601 weights Y = (29 B + 150 G + 77 R + 128) >> 8. Every variant
+// produces bit-identical output.
+void bgrToGrayRowScalar(const unsigned char* bgr, unsigned char* gray, size_t width);
+
+// Compiled with AVX2 code generation; only call when avx2Available()
+void bgrToGrayRowAvx2(const unsigned char* bgr, unsigned char* gray, size_t width);
+
+// True when the AVX2 kernel was built and the CPU/OS can run it
+bool avx2Available();
+
+// Picks the fastest kernel available at runtime
+void bgrToGrayRow(const unsigned char* bgr, unsigned char* gray, size_t width);
+
+// Luma extraction from packed YUYV (Y0 U Y1 V); no arithmetic, just the Y bytes
+void yuyvToGrayRowScalar(const unsigned char* yuyv, unsigned char* gray, size_t width);
+void yuyvToGrayRowAvx2(const unsigned char* yuyv, unsigned char* gray, size_t width);
+void yuyvToGrayRow(const unsigned char* yuyv, unsigned char* gray, size_t width);
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <dlib/array2d.h>
+#include <dlib/image_transforms.h>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace capvision {
+namespace core {
+
+// Grayscale image pyramid shared by every stage of the pipeline. Level 0 is
+// written straight from the camera frame: BGR goes through the fused
+// BGR-to-luma kernel, YUYV has its Y plane lifted out and 8-bit gray is
+// copied. The upper levels are pyramid_down<6> reductions matching the HOG
+// scanner. Storage is reused between frames, so steady-state rebuilds do not
+// allocate.
+class GrayPyramid {
+public:
+    using level_type = dlib::array2d<unsigned char>;
+
+    // Rebuild from a CV_8UC3 BGR, CV_8UC2 YUYV or CV_8UC1 gray frame with the
+    // given number of levels (>= 1)
+    void build(const cv::Mat& frame, unsigned long num_levels);
+
+    size_t size() const { return num_levels_; }
+    const level_type& level(size_t index) const { return levels_[index]; }
+
+    // OpenCV header over a level's pixels; no copy, valid until the next build
+    cv::Mat levelMat(size_t index) const;
+
+private:
+    std::vector<level_type> levels_;
+    unsigned long num_levels_{0};
+};
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <array>
+#include "landmark_array.hpp"
+
+namespace capvision {
+namespace core {
+
+// Head rotation from six of the 68 landmarks (nose tip, chin, eye and mouth
+// corners) fitted with solvePnP to a generic 3D face, for a pinhole camera
+// whose focal length is the frame width. Fixed-size state only: estimating
+// does not allocate.
+class HeadPoseEstimator {
+public:
+    HeadPoseEstimator();
+
+    // False without the 68-point layout. eulerDegrees is the rotation
+    // vector in degrees (pitch, yaw, roll for small angles).
+    bool estimate(const LandmarkArray& landmarks, const cv::Size& frameSize,
+                  cv::Matx33d& rotation, cv::Vec3d& eulerDegrees);
+
+private:
+    std::array<cv::Point3d, 6> model_points_3d_;
+    cv::Matx33d camera_matrix_;   // Rebuilt when the frame size changes
+    cv::Vec4d dist_coeffs_;       // Assumed zero for webcams
+};
+
+} // namespace core
+} // namespace capvision
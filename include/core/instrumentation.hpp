@@ -0,0 +1,39 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace capvision {
+namespace core {
+
+// Process-wide named values for monitoring the pipeline. Gauges hold the
+// latest value (a quality level, a stage cost), counters accumulate (frames
+// skipped). Names are dotted, e.g. "scheduler.level". Updating a name that
+// already exists does not allocate, so stages can publish every frame.
+class Instrumentation {
+public:
+    static Instrumentation& global();
+
+    void set(std::string_view name, double value);
+    void add(std::string_view name, double delta = 1.0);
+
+    // 0 if the name was never published
+    double value(std::string_view name) const;
+
+    // Every value, sorted by name
+    std::vector<std::pair<std::string, double>> snapshot() const;
+
+    // Snapshot on one line: "name=value name=value ..."
+    std::string format() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, double, std::less<>> values_;
+};
+
+} // namespace core
+} // namespace capvision
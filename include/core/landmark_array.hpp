@@ -0,0 +1,61 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace capvision {
+namespace core {
+
+// Landmark points stored inline, up to the 68 of dlib's face model. Offers
+// the parts of std::vector's interface the pipeline uses; copying one (and
+// so a whole detection result) never touches the heap. Points past the
+// capacity are dropped.
+class LandmarkArray {
+public:
+    static constexpr size_t kCapacity = 68;
+
+    using value_type = cv::Point2f;
+    using iterator = cv::Point2f*;
+    using const_iterator = const cv::Point2f*;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    static constexpr size_t capacity() { return kCapacity; }
+
+    cv::Point2f& operator[](size_t i) { return points_[i]; }
+    const cv::Point2f& operator[](size_t i) const { return points_[i]; }
+
+    cv::Point2f* data() { return points_.data(); }
+    const cv::Point2f* data() const { return points_.data(); }
+    iterator begin() { return points_.data(); }
+    iterator end() { return points_.data() + size_; }
+    const_iterator begin() const { return points_.data(); }
+    const_iterator end() const { return points_.data() + size_; }
+
+    void clear() { size_ = 0; }
+
+    // New points are (0, 0)
+    void resize(size_t count) {
+        count = std::min(count, kCapacity);
+        std::fill(points_.begin() + size_, points_.begin() + std::max<size_t>(count, size_), cv::Point2f());
+        size_ = static_cast<uint32_t>(count);
+    }
+
+    void push_back(const cv::Point2f& point) {
+        if (size_ < kCapacity) {
+            points_[size_++] = point;
+        }
+    }
+
+    void emplace_back(float x, float y) { push_back(cv::Point2f(x, y)); }
+
+private:
+    std::array<cv::Point2f, kCapacity> points_{};
+    uint32_t size_{0};
+};
+
+} // namespace core
+} // namespace capvision
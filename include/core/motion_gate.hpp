@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include "face_detector.hpp"
+
+namespace capvision {
+namespace core {
+
+// Decides before detection whether a frame differs enough from the last
+// detected one to be worth detecting again. Each frame is reduced to a small
+// grayscale thumbnail (BGR, BGRA, gray or YUYV input) and compared with the
+// thumbnail of the frame detection last ran on. The comparison covers the
+// face plus a margin while a face is known, and the whole frame otherwise.
+// A static frame reuses the previous result.
+//
+// The previous result is still refreshed now and then, to follow slow
+// lighting changes. While a face is known that happens every
+// max_reuse_frames frames. Once no face has been seen for idle_after_ms the
+// gate goes idle and rescans a static scene only every idle_scan_ms. Any
+// motion triggers detection on the next frame, idle or not.
+//
+// Publishes gate.reused (counter), gate.idle and gate.changed (fraction of
+// watched cells that changed) to Instrumentation.
+class MotionGate {
+public:
+    struct Config {
+        cv::Size thumbnail{64, 48};
+        int pixel_threshold{12};          // Gray-level change for a cell to count
+        double changed_fraction{0.004};   // Share of watched cells that must change
+        double face_margin{0.5};          // Watched area around a face, in face widths
+        int max_reuse_frames{30};         // Detect at least this often with a face
+        double idle_after_ms{3000.0};     // No face for this long: idle
+        double idle_scan_ms{1000.0};      // Rescan a static idle scene this often
+    };
+
+    MotionGate();
+    explicit MotionGate(const Config& config);
+
+    // True when frame must be detected; false to reuse the last result
+    bool check(const cv::Mat& frame, int64_t timestampUs);
+
+    // After a detection ran on the frame last passed to check()
+    void update(const FaceDetector::FaceDetectionResult& result, int64_t timestampUs);
+
+    bool idle() const { return idle_; }
+    double lastChangedFraction() const { return changed_; }
+
+    void reset();
+
+private:
+    void makeThumbnail(const cv::Mat& frame);
+    cv::Rect watchedRegion() const;
+
+    Config config_;
+    cv::Mat scaled_;      // Thumbnail before the gray conversion
+    cv::Mat thumbnail_;   // Of the frame last checked
+    cv::Mat reference_;   // Of the frame last detected
+    cv::Mat diff_;
+    cv::Size frame_size_;
+    bool has_reference_{false};
+    bool has_face_{false};
+    cv::Rect face_rect_;  // In frame pixels
+    int reused_frames_{0};
+    int64_t last_detect_us_{0};
+    int64_t last_face_us_{0};
+    bool idle_{false};
+    double changed_{0.0};
+};
+
+} // namespace core
+} // namespace capvision
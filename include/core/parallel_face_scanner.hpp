@@ -0,0 +1,151 @@
+#pragma once
+
+#include <dlib/image_processing.h>
+#include <dlib/image_processing/frontal_face_detector.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "gray_pyramid.hpp"
+#include "thread_pool.hpp"
+
+namespace capvision {
+namespace core {
+
+// Runs dlib's frontal face detector with every image-pyramid level scanned
+// concurrently on a thread pool. Levels larger than the tiling threshold are
+// split into overlapping tiles whose halo covers a full detection window plus
+// the HOG normalisation neighbourhood, so each window is scored from the same
+// features as in a whole-image scan. The raw detections of all levels are
+// merged with the detector's own overlap tester, which reproduces
+// detector_(img) up to the order of equal-score boxes. Without a pool the
+// same jobs run on the calling thread.
+class ParallelFaceScanner {
+public:
+    using detector_type = dlib::frontal_face_detector;
+    using scanner_type = detector_type::image_scanner_type;
+    using pyramid_type = scanner_type::pyramid_type;
+
+    struct Config {
+        long tile_size{256};            // Core tile edge in pixels, rounded up to the HOG cell size
+        long min_tiled_dimension{480};  // Levels wider or taller than this are tiled
+    };
+
+    ParallelFaceScanner(const detector_type& detector, std::shared_ptr<ThreadPool> pool);
+    ParallelFaceScanner(const detector_type& detector, std::shared_ptr<ThreadPool> pool,
+                        const Config& config);
+
+    template <typename image_type>
+    std::vector<dlib::rectangle> operator()(const image_type& img, double adjust_threshold = 0);
+
+    // Scan a prebuilt grayscale pyramid; its levels must come from
+    // countPyramidLevels() so nothing is rebuilt here. Levels below
+    // first_level are skipped: the finest levels cost the most and only
+    // contribute the smallest faces.
+    std::vector<dlib::rectangle> operator()(const GrayPyramid& pyramid, double adjust_threshold = 0,
+                                            unsigned long first_level = 0);
+
+    // Number of levels the detector scans for an image of the given size
+    unsigned long countPyramidLevels(const dlib::rectangle& image_rect) const;
+
+private:
+    // One unit of work: a whole pyramid level or one tile of it
+    struct ScanJob {
+        unsigned long level{0};
+        dlib::rectangle tile;   // Scanned area, in level coordinates
+        dlib::rectangle core;   // Detections are kept only if centred in here
+        bool tiled{false};
+    };
+
+    using JobScanner = std::function<void(const ScanJob&, std::vector<dlib::rect_detection>&)>;
+
+    void planLevel(unsigned long level, const dlib::rectangle& level_rect,
+                   std::vector<ScanJob>& jobs) const;
+    std::vector<dlib::rectangle> scanJobs(std::vector<ScanJob>& jobs, const JobScanner& scan) const;
+    std::vector<dlib::rectangle> mergeDetections(
+        std::vector<std::vector<dlib::rect_detection>>& job_detections) const;
+
+    template <typename image_type>
+    void scanJob(const image_type& level_img, const ScanJob& job, double adjust_threshold,
+                 std::vector<dlib::rect_detection>& detections) const;
+
+    std::shared_ptr<ThreadPool> pool_;
+    Config config_;
+
+    // Scanner configuration limited to a single pyramid level
+    scanner_type scanner_config_;
+    unsigned long max_pyramid_levels_{0};
+    std::vector<scanner_type::fhog_filterbank> filterbanks_;
+    std::vector<double> thresholds_;
+    dlib::test_box_overlap overlap_tester_;
+    long halo_{0};
+};
+
+template <typename image_type>
+std::vector<dlib::rectangle> ParallelFaceScanner::operator()(const image_type& img,
+                                                             double adjust_threshold) {
+    using pixel_type = typename dlib::image_traits<image_type>::pixel_type;
+
+    const unsigned long num_levels = countPyramidLevels(dlib::get_rect(img));
+
+    // Downsampling is cheap next to HOG extraction and filtering, so the levels
+    // are built sequentially the same way scan_fhog_pyramid builds them.
+    std::vector<dlib::array2d<pixel_type>> levels(num_levels - 1);
+    pyramid_type pyr;
+    for (unsigned long l = 1; l < num_levels; ++l) {
+        if (l == 1) {
+            pyr(img, levels[0]);
+        } else {
+            pyr(levels[l - 2], levels[l - 1]);
+        }
+    }
+
+    std::vector<ScanJob> jobs;
+    planLevel(0, dlib::get_rect(img), jobs);
+    for (unsigned long l = 1; l < num_levels; ++l) {
+        planLevel(l, dlib::get_rect(levels[l - 1]), jobs);
+    }
+
+    return scanJobs(jobs, [&](const ScanJob& job, std::vector<dlib::rect_detection>& dets) {
+        if (job.level == 0) {
+            scanJob(img, job, adjust_threshold, dets);
+        } else {
+            scanJob(levels[job.level - 1], job, adjust_threshold, dets);
+        }
+    });
+}
+
+template <typename image_type>
+void ParallelFaceScanner::scanJob(const image_type& level_img, const ScanJob& job,
+                                  double adjust_threshold,
+                                  std::vector<dlib::rect_detection>& detections) const {
+    // fhog scanners are noncopyable; each job gets its own feature storage
+    scanner_type scanner;
+    scanner.copy_configuration(scanner_config_);
+    if (job.tiled) {
+        scanner.load(dlib::sub_image(level_img, job.tile));
+    } else {
+        scanner.load(level_img);
+    }
+
+    pyramid_type pyr;
+    std::vector<std::pair<double, dlib::rectangle>> dets;
+    for (unsigned long i = 0; i < filterbanks_.size(); ++i) {
+        scanner.detect(filterbanks_[i], dets, thresholds_[i] + adjust_threshold);
+        for (const auto& det : dets) {
+            const dlib::rectangle rect = dlib::translate_rect(det.second, job.tile.tl_corner());
+            if (job.tiled && !job.core.contains(dlib::center(rect))) {
+                continue;
+            }
+
+            dlib::rect_detection detection;
+            detection.detection_confidence = det.first - thresholds_[i];
+            detection.weight_index = i;
+            detection.rect = pyr.rect_up(rect, job.level);
+            detections.push_back(detection);
+        }
+    }
+}
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "face_detector.hpp"
+
+namespace capvision {
+namespace core {
+
+// Smooths a face's landmarks and head rotation over time and extrapolates
+// them to a later moment, so an overlay can be placed where the head is at
+// display time rather than where it was at capture time. Each coordinate
+// and each rotation-vector component runs through a One-Euro filter: a
+// low-pass whose cutoff rises with speed, steady when the head is still and
+// responsive when it turns. Prediction continues the filtered velocity.
+//
+// Every update first measures how far the prediction for its capture time
+// was from the detection that arrived, and publishes the smoothed residual
+// as pose.residual_px / pose.residual_deg for tuning.
+class PosePredictor {
+public:
+    struct FilterParams {
+        double min_cutoff_hz;   // Cutoff while still: lower is steadier
+        double beta;            // Cutoff increase per unit of speed: higher lags less
+    };
+
+    struct Config {
+        FilterParams landmarks{1.5, 0.01};   // Speed in pixels per second
+        FilterParams rotation{1.5, 0.5};     // Speed in radians per second
+        double derivative_cutoff_hz{1.0};
+        double max_horizon_ms{100.0};        // Never extrapolate further than this
+    };
+
+    // Distance between a prediction and the detection for the same time
+    struct Residual {
+        double landmark_px{0.0};    // Mean over landmarks
+        double rotation_deg{0.0};   // Angle between the rotations
+    };
+
+    PosePredictor();
+    explicit PosePredictor(const Config& config);
+
+    // A detection captured at captureUs (steady clock); a failed one resets
+    void update(const FaceDetector::FaceDetectionResult& result, int64_t captureUs);
+
+    // Filtered pose extrapolated to atUs; success is false without a face
+    FaceDetector::FaceDetectionResult predict(int64_t atUs) const;
+
+    bool hasFace() const { return has_face_; }
+    int64_t lastCaptureUs() const { return last_us_; }
+    const Residual& lastResidual() const { return residual_; }
+
+    void reset();
+
+private:
+    struct Channel {
+        double value{0.0};
+        double velocity{0.0};   // Filtered, per second
+    };
+
+    static constexpr size_t kLandmarkChannels = 2 * LandmarkArray::kCapacity;
+    static constexpr size_t kChannels = kLandmarkChannels + 3;
+
+    void filter(Channel& channel, double measured, double dt, const FilterParams& params) const;
+
+    Config config_;
+    std::array<Channel, kChannels> channels_{};   // x0 y0 x1 y1 ... then rvec
+    size_t landmark_count_{0};
+    cv::Rect face_rect_;
+    cv::Point2d rect_anchor_;   // Landmark centroid when face_rect_ was taken
+    bool has_face_{false};
+    int64_t last_us_{0};
+    Residual residual_;
+    Residual smoothed_residual_;
+};
+
+} // namespace core
+} // namespace capvision
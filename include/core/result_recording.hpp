@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "face_detector.hpp"
+
+namespace capvision {
+namespace core {
+
+// Compact recording of detection results (.cvr), so a session can be
+// re-rendered without running the detector again.
+//
+// File layout: a fixed header, one variable-length record per frame, then a
+// keyframe index. Every value is quantized to an integer (landmarks to
+// 1/16 px, rotation to 1/32768, Euler angles to 1/1000 degree) and stored as
+// a zigzag varint delta against the previous face, so a still face costs a
+// few bytes per frame. Keyframes store absolute values every
+// keyframe_interval frames and are listed in the index for seeking. A file
+// whose recorder did not close cleanly has no index; the reader rebuilds
+// it by scanning.
+struct RecordedFrame {
+    int64_t timestamp_us{0};
+    uint64_t index{0};   // Frame number in the recording
+    FaceDetector::FaceDetectionResult result;
+};
+
+class ResultRecorder {
+public:
+    struct Options {
+        uint32_t keyframe_interval{30};
+        int frame_width{0};    // Size of the recorded video, for replay
+        int frame_height{0};
+    };
+
+    ResultRecorder();
+    ~ResultRecorder();
+
+    ResultRecorder(const ResultRecorder&) = delete;
+    ResultRecorder& operator=(const ResultRecorder&) = delete;
+
+    bool open(const std::string& path, const Options& options);
+    bool isOpen() const { return file_.is_open(); }
+
+    bool append(int64_t timestampUs, const FaceDetector::FaceDetectionResult& result);
+
+    // Write the index and the final header
+    bool close();
+
+    uint64_t frameCount() const { return frame_count_; }
+
+private:
+    struct IndexEntry {
+        uint64_t frame;
+        uint64_t offset;
+        int64_t timestamp_us;
+    };
+
+    std::ofstream file_;
+    Options options_;
+    uint64_t frame_count_{0};
+    uint64_t offset_{0};
+    int64_t last_timestamp_us_{0};
+    std::vector<int32_t> reference_;   // Quantized values of the previous face
+    std::vector<int32_t> values_;
+    std::vector<uint8_t> record_;
+    std::vector<IndexEntry> index_;
+};
+
+// Memory-mapped reader for .cvr files. Decoding is sequential from the
+// nearest keyframe, so next() is a few hundred integer ops per frame and
+// seek() touches at most keyframe_interval records.
+class ResultReplay {
+public:
+    ResultReplay();
+    ~ResultReplay();
+
+    ResultReplay(const ResultReplay&) = delete;
+    ResultReplay& operator=(const ResultReplay&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return data_ != nullptr; }
+
+    uint64_t frameCount() const { return frame_count_; }
+    int frameWidth() const { return frame_width_; }
+    int frameHeight() const { return frame_height_; }
+    int64_t firstTimestampUs() const { return first_timestamp_us_; }
+
+    // Position so that next() returns frame `frame`
+    bool seek(uint64_t frame);
+
+    // Decode the next frame; false at the end of the recording
+    bool next(RecordedFrame& frame);
+
+private:
+    struct IndexEntry {
+        uint64_t frame;
+        uint64_t offset;
+        int64_t timestamp_us;
+    };
+
+    bool decodeRecord(RecordedFrame* frame);
+    void rebuildIndex();
+
+    const uint8_t* data_{nullptr};
+    size_t size_{0};
+    size_t records_end_{0};
+    std::vector<uint8_t> buffer_;   // File contents where mmap is unavailable
+    void* mapping_{nullptr};
+
+    uint64_t frame_count_{0};
+    int frame_width_{0};
+    int frame_height_{0};
+    int64_t first_timestamp_us_{0};
+    std::vector<IndexEntry> index_;
+
+    size_t cursor_{0};
+    uint64_t next_frame_{0};
+    int64_t last_timestamp_us_{0};
+    std::vector<int32_t> reference_;
+};
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "capture_source.hpp"
+#include "face_detector.hpp"
+
+namespace capvision {
+namespace core {
+
+#ifndef _WIN32
+
+// Frame transport between processes over one POSIX shared-memory segment.
+// A producer process writes frames into fixed slots and the detector side
+// reads them in place; results travel back in a second ring in the same
+// segment. Each ring has a single writer and a single reader and is driven
+// only by two monotonically increasing counters, so neither side ever
+// blocks the other:
+//   - frames: the producer never overwrites a slot the consumer has not
+//     released, and drops the frame instead when all slots are in use
+//   - results: the consumer drops a result when the producer stops reading
+class SharedFrameRing {
+public:
+    struct Layout {
+        uint32_t slot_count{4};
+        uint32_t slot_capacity{1920 * 1080 * 3};  // Bytes of pixel data per slot
+        uint32_t result_count{16};
+    };
+
+    static constexpr uint32_t kMaxLandmarks = 68;
+
+    // Detection result as stored in the result ring
+    struct ResultRecord {
+        uint64_t frame_sequence{0};
+        int64_t timestamp_us{0};    // Capture timestamp of the frame
+        uint32_t success{0};
+        int32_t face_rect[4]{};
+        uint32_t landmark_count{0};
+        float landmarks[kMaxLandmarks * 2]{};
+        double rotation_matrix[9]{};
+        double euler_angles[3]{};
+    };
+
+    // Create (or replace) the segment `name`, e.g. "/capvision". The creator
+    // owns the segment and unlinks it on destruction.
+    static std::unique_ptr<SharedFrameRing> create(const std::string& name, const Layout& layout);
+
+    // Map an existing segment; nullptr if it does not exist or is not a ring
+    static std::unique_ptr<SharedFrameRing> attach(const std::string& name);
+
+    ~SharedFrameRing();
+
+    SharedFrameRing(const SharedFrameRing&) = delete;
+    SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+    const Layout& layout() const { return layout_; }
+
+    // Producer: pixel memory of the next free slot, or nullptr when every
+    // slot still waits for the consumer (the frame is counted as dropped).
+    // Fill it, then commitFrame(); nothing is visible before the commit.
+    // MJPEG frames are committed as width = byte count, height = 1.
+    uint8_t* beginFrame();
+    bool commitFrame(int width, int height, size_t stride, PixelFormat format,
+                     int64_t timestampUs, uint64_t sequence);
+
+    // Producer: next result from the consumer, false if none is pending
+    bool readResult(ResultRecord& record);
+
+    // Consumer: borrow the oldest unread frame, or the newest one with
+    // `newestOnly` (older frames are released unseen). `frame.image` points
+    // into the segment and stays valid until releaseFrame().
+    bool acquireFrame(CapturedFrame& frame, bool newestOnly);
+    void releaseFrame();
+
+    // Consumer: false if the result ring is full
+    bool writeResult(uint64_t frameSequence, int64_t timestampUs,
+                     const FaceDetector::FaceDetectionResult& result);
+
+    uint64_t framesDropped() const;
+    uint64_t resultsDropped() const;
+
+private:
+    struct ControlBlock;
+    struct SlotHeader;
+
+    SharedFrameRing() = default;
+    bool map(int fd, size_t size);
+    SlotHeader* slot(uint64_t index) const;
+    ResultRecord* result(uint64_t index) const;
+
+    std::string name_;
+    bool owner_{false};
+    Layout layout_;
+    uint8_t* base_{nullptr};
+    size_t size_{0};
+    size_t slot_stride_{0};
+    size_t results_offset_{0};
+    ControlBlock* control_{nullptr};
+
+    bool holding_{false};
+    uint64_t held_index_{0};
+};
+
+#endif
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "capture_source.hpp"
+#include "face_detector.hpp"
+#include "shared_frame_ring.hpp"
+
+namespace capvision {
+namespace core {
+
+#ifndef _WIN32
+
+// CaptureSource reading a SharedFrameRing in place: read() returns the
+// newest frame without copying and releases the previous one. open() and
+// read() poll for up to timeout_ms, so the consumer may start before the
+// producer; 0 makes both non-blocking.
+class ShmCaptureSource : public CaptureSource {
+public:
+    struct Options {
+        int timeout_ms{1000};
+        bool newest_only{true};   // false: process every frame in order
+    };
+
+    explicit ShmCaptureSource(const std::string& name);
+    ShmCaptureSource(const std::string& name, const Options& options);
+    ~ShmCaptureSource() override;
+
+    bool open() override;
+    bool isOpened() const override { return ring_ != nullptr; }
+    void close() override;
+    bool read(CapturedFrame& frame) override;
+
+    // Send the result for `frame` back to the producer
+    bool publishResult(const CapturedFrame& frame, const FaceDetector::FaceDetectionResult& result);
+
+    SharedFrameRing* ring() const { return ring_.get(); }
+
+private:
+    std::string name_;
+    Options options_;
+    std::unique_ptr<SharedFrameRing> ring_;
+};
+
+#endif
+
+} // namespace core
+} // namespace capvision
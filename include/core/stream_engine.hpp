@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "capture_source.hpp"
+#include "face_detector.hpp"
+
+namespace capvision {
+namespace core {
+
+// Headless engine running face detection for several capture sources on one
+// shared pool of workers. Each worker owns a detector; streams only hold
+// their freshest unprocessed frame. Workers serve streams round-robin with at
+// most one frame of a stream in flight, so a busy camera cannot starve the
+// others, and frames that already exceed the latency budget when picked up
+// are dropped instead of processed late.
+class StreamEngine {
+public:
+    struct Config {
+        size_t worker_count{0};          // 0 = one per hardware thread
+        double latency_budget_ms{100.0}; // Capture-to-start age after which a frame is dropped
+    };
+
+    struct StreamResult {
+        size_t stream_id{0};
+        uint64_t sequence{0};
+        int64_t capture_us{0};
+        int64_t completed_us{0};
+        FaceDetector::FaceDetectionResult face;
+    };
+
+    struct StreamStats {
+        uint64_t frames_captured{0};
+        uint64_t frames_processed{0};
+        uint64_t frames_dropped{0};      // Replaced before pickup or over budget
+        double mean_latency_ms{0.0};     // Capture to result, over the recent window
+        double p50_latency_ms{0.0};
+        double p95_latency_ms{0.0};
+        double max_latency_ms{0.0};
+    };
+
+    // Called on a worker thread; results of one stream arrive in order
+    using ResultCallback = std::function<void(const StreamResult&)>;
+
+    explicit StreamEngine(const Config& config);
+    ~StreamEngine();
+
+    StreamEngine(const StreamEngine&) = delete;
+    StreamEngine& operator=(const StreamEngine&) = delete;
+
+    // Register a source before start(); returns its stream id
+    size_t addStream(std::unique_ptr<CaptureSource> source, ResultCallback callback);
+
+    bool start();
+    void stop();
+
+    size_t streamCount() const { return streams_.size(); }
+    StreamStats stats(size_t streamId) const;
+
+    // Processed frames per second over all streams since start()
+    double throughputFps() const;
+
+private:
+    struct Stream {
+        std::unique_ptr<CaptureSource> source;
+        ResultCallback callback;
+        std::thread capture_thread;
+
+        // Guarded by the engine mutex
+        CapturedFrame pending;
+        bool has_pending{false};
+        bool in_flight{false};
+
+        // Guarded by stats_mutex
+        mutable std::mutex stats_mutex;
+        uint64_t frames_captured{0};
+        uint64_t frames_processed{0};
+        uint64_t frames_dropped{0};
+        std::vector<double> latencies_ms;   // Ring of recent latencies
+        size_t latency_cursor{0};
+    };
+
+    void captureLoop(Stream& stream);
+    void workerLoop(FaceDetector& detector);
+    void recordLatency(Stream& stream, double latency_ms);
+
+    Config config_;
+    std::vector<std::unique_ptr<Stream>> streams_;
+    std::vector<std::unique_ptr<FaceDetector>> detectors_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    size_t next_stream_{0};   // Round-robin cursor
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> total_processed_{0};
+    int64_t start_us_{0};
+};
+
+} // namespace core
+} // namespace capvision
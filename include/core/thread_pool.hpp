@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace capvision {
+namespace core {
+
+// Fixed-size pool of worker threads shared by the detection pipeline.
+class ThreadPool {
+public:
+    // threadCount == 0 picks one worker per hardware thread
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    // Queue a task and get a future for its result
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using result_type = std::invoke_result_t<std::decay_t<F>>;
+        auto packaged = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(task));
+        std::future<result_type> future = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return future;
+    }
+
+    // Run body(0) .. body(count - 1) on the pool and wait for all of them.
+    // The calling thread claims work too, so this is safe to call from a
+    // pool worker without risking a deadlock.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+private:
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stopping_{false};
+};
+
+} // namespace core
+} // namespace capvision
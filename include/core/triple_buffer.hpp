@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace capvision {
+namespace core {
+
+// Latest-value handoff from one producer thread to one consumer thread
+// without locks. Of three slots, the producer owns one (back), the consumer
+// owns one (front) and the third (middle) is exchanged atomically: publish()
+// swaps the filled back slot into the middle, consume() swaps the middle
+// into the front when something newer was published. Neither side ever
+// waits; a value the consumer has not taken yet is simply replaced. Slots
+// are reused, so buffers inside T keep their storage between frames.
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer: the slot to fill; it holds whatever was published two or
+    // more values ago
+    T& back() { return slots_[back_]; }
+
+    // Producer: make back() the newest value
+    void publish() {
+        back_ = middle_.exchange(static_cast<uint8_t>(back_ | kFresh), std::memory_order_acq_rel) & kIndex;
+    }
+
+    // Consumer: true if a value was published since the last call, and
+    // front() is now that value
+    bool consume() {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+
+    // Consumer: the last value taken by consume()
+    T& front() { return slots_[front_]; }
+
+private:
+    static constexpr uint8_t kIndex = 0x3;
+    static constexpr uint8_t kFresh = 0x4;   // Middle was published, not consumed
+
+    std::array<T, 3> slots_{};
+    uint8_t back_{0};
+    uint8_t front_{1};
+    std::atomic<uint8_t> middle_{2};
+};
+
+} // namespace core
+} // namespace capvision
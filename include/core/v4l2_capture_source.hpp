@@ -0,0 +1,63 @@
+#pragma once
+
+#include "capture_source.hpp"
+#include <string>
+#include <vector>
+
+namespace capvision {
+namespace core {
+
+#ifdef __linux__
+
+// Video4Linux2 camera using memory-mapped driver buffers. Frames are handed
+// out in place (no copy) with the kernel capture timestamp, and the smallest
+// queue the driver accepts keeps latency to about one frame: every read()
+// drains whatever completed since the last call and returns only the newest.
+class V4l2CaptureSource : public CaptureSource {
+public:
+    struct Options {
+        std::string device{"/dev/video0"};
+        int width{640};
+        int height{480};
+        int fps{30};
+        PixelFormat format{PixelFormat::YUYV};  // YUYV or MJPEG
+        unsigned int buffer_count{2};           // Driver may round this up
+        int timeout_ms{1000};
+    };
+
+    explicit V4l2CaptureSource(const Options& options);
+    ~V4l2CaptureSource() override;
+
+    bool open() override;
+    bool isOpened() const override { return streaming_; }
+    void close() override;
+    bool read(CapturedFrame& frame) override;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+private:
+    struct MappedBuffer {
+        void* start{nullptr};
+        size_t length{0};
+    };
+
+    bool configureFormat();
+    bool mapBuffers();
+    bool queueBuffer(unsigned int index);
+    void fail(const char* what);
+
+    Options options_;
+    int fd_{-1};
+    bool streaming_{false};
+    int width_{0};
+    int height_{0};
+    size_t bytes_per_line_{0};
+    std::vector<MappedBuffer> buffers_;
+    int held_index_{-1};   // Buffer currently lent out through read()
+};
+
+#endif
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "../../include/core/face_detector.hpp"
+
+namespace capvision {
+namespace ui {
+
+// How a cap sits on a detected face: the transform FrameRenderer renders with,
+// shared with the offscreen tools so their composites match the app.
+struct CapPlacement {
+    float scale{0.0008f};           // Cap size per pixel of eye distance
+    float verticalOffset{0.42f};    // Above the nose, in clip-space units
+    float depthOffset{-3.0f};       // Distance from the camera
+    glm::vec3 rotationOffset{-90.0f, 180.0f, 0.0f};   // Model to head, in degrees
+};
+
+// Model matrix of a cap on face, for an image of width x height pixels
+// shown over the whole viewport. Needs landmarks 30, 36 and 45.
+glm::mat4 capModelMatrix(const core::FaceDetector::FaceDetectionResult& face,
+                         int width, int height, const CapPlacement& placement = CapPlacement{});
+
+// The camera the cap model matrices are built for
+glm::mat4 capViewMatrix();
+glm::mat4 capProjectionMatrix(float aspectRatio);
+
+} // namespace ui
+} // namespace capvision
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "model3d.hpp"
+#include "shader_variants.hpp"
+
+namespace capvision {
+namespace ui {
+
+// Draws caps for any number of faces. The model matrices of all faces
+// wearing the same cap go into one instance buffer and each of its meshes
+// is drawn once, so the draw count does not grow with the number of faces.
+// Needs a current GL context with GLEW initialised; it does not depend on
+// Qt, so it also runs offscreen in the benchmarks.
+class CapRenderer {
+public:
+    CapRenderer();
+
+    // Compile the cap shader variants; false if any fails
+    bool initialize();
+
+    // Load a cap model; false if nothing could be read from path
+    bool loadModel(const std::string& path);
+    size_t modelCount() const { return models_.size(); }
+
+    // Drop a cap; textures no other loaded cap uses are freed
+    void unloadModel(size_t modelIndex);
+
+    // Every face in modelMatrices wearing cap modelIndex, one instanced draw
+    // per mesh
+    void render(size_t modelIndex, const std::vector<glm::mat4>& modelMatrices,
+                const glm::mat4& projection, const glm::mat4& view, int lod = 0);
+
+    // The same caps drawn one face at a time, as before instancing; kept for
+    // comparison in the benchmarks
+    void renderEach(size_t modelIndex, const std::vector<glm::mat4>& modelMatrices,
+                    const glm::mat4& projection, const glm::mat4& view, int lod = 0);
+
+private:
+    void setupFrame(const glm::mat4& projection, const glm::mat4& view);
+
+    ShaderVariants shaders_;
+    std::vector<std::unique_ptr<Model3D>> models_;
+};
+
+} // namespace ui
+} // namespace capvision
@@ -29,11 +29,11 @@ public:
                            const Options& options);
 
     static void drawLandmarks(cv::Mat& frame, 
-                            const std::vector<cv::Point2f>& landmarks,
+                            const core::LandmarkArray& landmarks,
                             const Options& options);
 
     static void drawFaceConnections(cv::Mat& frame, 
-                                  const std::vector<cv::Point2f>& landmarks,
+                                  const core::LandmarkArray& landmarks,
                                   const Options& options);
 
     // TODO debug drawPoseAxes
@@ -46,8 +46,8 @@ public:
                                const Options& options);
 private:
     // Camera matrix and distortion coefficients for axis projection
-    static inline cv::Mat camera_matrix_;
-    static inline cv::Mat dist_coeffs_ = cv::Mat::zeros(4, 1, cv::DataType<double>::type);
+    static inline cv::Matx33d camera_matrix_;
+    static inline cv::Vec4d dist_coeffs_;
 };
 
 } // namespace ui
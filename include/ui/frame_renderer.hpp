@@ -0,0 +1,119 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "../../include/core/face_detector.hpp"
+#include "../../include/ui/shader.hpp"
+#include "../../include/ui/cap_placement.hpp"
+#include "../../include/ui/cap_renderer.hpp"
+#include "../../include/ui/gpu_profiler.hpp"
+#include <glm/glm.hpp>
+
+namespace capvision {
+namespace ui {
+
+// Draws a video frame with a cap on every face: the frame textures, the
+// video quad and the cap renderer. Owns no context and no window, so it
+// runs in OpenGLWidget on the GUI thread as well as on RenderWindow's
+// render thread. Every call except setFaces needs the same GL context
+// current; initialize() also runs glewInit for it.
+class FrameRenderer {
+public:
+    static constexpr const char* kDefaultCapModel = "resources/models/caps/10131_BaseballCap_v2_L3.obj";
+
+    FrameRenderer() = default;
+    FrameRenderer(const FrameRenderer&) = delete;
+    FrameRenderer& operator=(const FrameRenderer&) = delete;
+
+    // Shaders, quad, textures and the cap model at capModelPath; false if
+    // GL or the video shader cannot be set up (a missing cap only warns)
+    bool initialize(const std::string& capModelPath);
+
+    // Free the GL objects; the context must still be current
+    void release();
+
+    // Viewport size in pixels; cap matrices follow it
+    void resize(int width, int height);
+
+    // Cap matrices for these faces (no GL calls)
+    void setFaces(const core::FaceDetector::FaceDetectionResult* faces, size_t count);
+
+    // Clear, then draw the video and the caps. frame, when not null, is
+    // uploaded first: BGR (CV_8UC3), or packed YUYV (CV_8UC2) with yuv
+    void render(const cv::Mat* frame, bool yuv, size_t capIndex, int capLod);
+
+    // GPU timer queries around the upload, video and cap passes; enabling
+    // fails (returns false) without timer query support
+    bool setGpuProfiling(bool enabled);
+    bool gpuProfiling() const { return gpuProfiler_.enabled(); }
+
+    size_t capCount() const { return capRenderer_.modelCount(); }
+
+private:
+    void setupQuad();
+    void uploadFrame(const cv::Mat& frame, bool yuv);
+    void renderVideo();
+
+    std::vector<core::FaceDetector::FaceDetectionResult> faces_;
+    std::vector<glm::mat4> capMatrices_;  // One per successful face in faces_
+    GLuint textureId_{0};         // BGR frame, or the luma plane in YUV mode
+    GLuint chromaTextureId_{0};   // YUYV viewed as RGBA macropixels: .g = U, .a = V
+    int textureWidth_{0};
+    int textureHeight_{0};
+    bool textureYuv_{false};
+    Shader videoShader_;
+    GLuint quadVAO_{0}, quadVBO_{0}, quadEBO_{0};
+
+    CapRenderer capRenderer_;
+    CapPlacement placement_;
+    glm::mat4 projection_{1.0f};
+    glm::mat4 view_{1.0f};
+    int width_{1};
+    int height_{1};
+
+    GpuProfiler gpuProfiler_;
+
+    // Shader sources
+    const std::string videoVertexShaderSource_ = R"(
+        #version 330 core
+        layout (location = 0) in vec3 aPos;
+        layout (location = 1) in vec2 aTexCoord;
+
+        out vec2 TexCoord;
+
+        void main() {
+            gl_Position = vec4(aPos, 1.0);
+            TexCoord = aTexCoord;
+        }
+    )";
+
+    const std::string videoFragmentShaderSource_ = R"(
+        #version 330 core
+        out vec4 FragColor;
+
+        in vec2 TexCoord;
+        uniform sampler2D videoTexture;
+        uniform sampler2D chromaTexture;
+        uniform bool yuvMode;
+
+        void main() {
+            if (!yuvMode) {
+                FragColor = texture(videoTexture, TexCoord);
+                return;
+            }
+
+            // BT.601 limited range, as delivered by UVC webcams
+            float y = 1.164 * (texture(videoTexture, TexCoord).r - 0.0625);
+            vec2 uv = texture(chromaTexture, TexCoord).ga - 0.5;
+            vec3 rgb = vec3(y + 1.596 * uv.y,
+                            y - 0.392 * uv.x - 0.813 * uv.y,
+                            y + 2.017 * uv.x);
+            FragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);
+        }
+    )";
+};
+
+} // namespace ui
+} // namespace capvision
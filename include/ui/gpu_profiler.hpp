@@ -0,0 +1,88 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace capvision {
+namespace ui {
+
+// GPU time of named render passes from GL_TIMESTAMP query pairs. Results
+// are read kFramesInFlight frames after they were issued, and only if the
+// GPU has finished them; a frame that is still running is dropped rather
+// than waited for. Each pass keeps the last kWindow samples; the mean and
+// maximum are published to core::Instrumentation as gpu.<pass>_ms and
+// gpu.<pass>_max_ms, next to the CPU stage.* timings, plus gpu.frame_ms
+// from the first pass's start to the last pass's end.
+//
+// Every call needs the GL context current. Off by default; while disabled
+// the calls do nothing.
+class GpuProfiler {
+public:
+    static constexpr int kMaxPasses = 8;
+    static constexpr int kFramesInFlight = 4;
+    static constexpr size_t kWindow = 120;
+
+    struct Stats {
+        double mean_ms{0.0};
+        double max_ms{0.0};
+        size_t samples{0};
+    };
+
+    GpuProfiler() = default;
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // Switch at runtime; enabling fails (returns false) without timer queries
+    bool setEnabled(bool enabled);
+    bool enabled() const { return enabled_; }
+
+    void beginFrame();
+    void beginPass(const char* name);
+    void endPass();
+    void endFrame();
+
+    // Rolling statistics of a pass; empty if it never completed
+    Stats stats(const std::string& pass) const;
+
+    // Delete the query objects; call while the context is still current
+    void release();
+
+private:
+    struct Pass {
+        std::string name;
+        std::string mean_key;   // Instrumentation names, built once
+        std::string max_key;
+        std::array<double, kWindow> samples{};
+        size_t count{0};
+        size_t next{0};
+
+        void add(double ms);
+        Stats stats() const;
+    };
+
+    struct Frame {
+        std::array<GLuint, 2 * kMaxPasses> queries{};
+        std::array<int, kMaxPasses> pass{};   // Index into passes_ of each query pair
+        int used{0};
+        bool pending{false};
+    };
+
+    int passIndex(const char* name);
+    void collect(Frame& frame);
+
+    bool enabled_{false};
+    bool created_{false};
+    std::array<Frame, kFramesInFlight> frames_;
+    uint64_t frameNumber_{0};
+    Frame* current_{nullptr};
+    bool inPass_{false};
+    std::vector<Pass> passes_;
+    Pass total_;
+};
+
+} // namespace ui
+} // namespace capvision
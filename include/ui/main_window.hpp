@@ -2,8 +2,18 @@
 
 #include <QtWidgets/QMainWindow>
 #include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
 #include "../../include/ui/opengl_widget.hpp"
+#include "../../include/ui/render_window.hpp"
+#include "../../include/core/capture_source.hpp"
 #include "../../include/core/face_detector.hpp"
+#include "../../include/core/face_tracker.hpp"
+#include "../../include/core/file_capture_source.hpp"
+#include "../../include/core/frame_scheduler.hpp"
+#include "../../include/core/motion_gate.hpp"
+#include "../../include/core/result_recording.hpp"
+#include "../../include/core/shm_capture_source.hpp"
 #include "../../include/ui/face_visualizer.hpp"
 
 namespace capvision {
@@ -13,7 +23,57 @@ class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
+    struct Options {
+        // Keep YUYV camera frames in YUV end to end: detection reads the Y
+        // plane and the video shader converts to RGB. CPU overlays need a BGR
+        // image and are skipped in this mode.
+        bool yuvPipeline{false};
+
+        // Read frames from this shared-memory ring instead of the camera and
+        // send results back through it (POSIX only)
+        std::string shmName;
+
+        // Append every detection result to this .cvr recording
+        std::string recordPath;
+
+        // Play a .cvr recording instead of running the camera and detector,
+        // over the matching video when replayVideoPath is set
+        std::string replayPath;
+        std::string replayVideoPath;
+
+        // Start each frame's landmark cascade from the previous frame's
+        // landmarks and run only its later levels
+        bool warmLandmarks{false};
+
+        // Per-frame budget the scheduler degrades quality to stay within;
+        // 0 always runs at full quality
+        double frameBudgetMs{33.3};
+
+        // Print the instrumentation values to stdout once a second
+        bool printStats{false};
+
+        // Filter the pose and place the cap from it extrapolated to display
+        // time: the shown frame's capture time plus poseLeadMs
+        bool predictPose{false};
+        double poseLeadMs{0.0};
+
+        // Start with GPU timer queries on; F3 toggles them at runtime
+        bool gpuTimers{false};
+
+        // Skip detection on frames that have not changed since the last
+        // detected one, and rescan slowly once no face has been seen
+        bool motionGate{false};
+
+        // Follow every face under a stable ID and put a cap on each
+        bool trackFaces{false};
+
+        // Render on a dedicated thread (RenderWindow) instead of in the GUI
+        // thread's paint events; falls back when the platform cannot
+        bool renderThread{false};
+    };
+
     explicit MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(const Options& options, QWidget *parent = nullptr);
     ~MainWindow();
 
 private slots:
@@ -22,14 +82,51 @@ private slots:
 private:
     void setupUi();
     void initializeCamera();
+    void shareResult(const core::FaceDetector::FaceDetectionResult& result);
+    void trackPose(const core::FaceDetector::FaceDetectionResult& result);
+    core::FaceDetector::FaceDetectionResult detect(const cv::Mat& frame);
+    void updateTracked(cv::Mat& frame, bool yuyv, double captureMs);
+    void updateReplay();
+    void scheduleFrame(double captureMs, double overlayMs);
+    void applySchedule();
+
+    Options options_;
 
     // UI components
-    OpenGLWidget* openglWidget_{nullptr};
+    VideoView* videoView_{nullptr};   // OpenGLWidget, or RenderWindow with renderThread
     QTimer* updateTimer_{nullptr};
 
     // Core components
-    cv::VideoCapture camera_;
+    std::unique_ptr<core::CaptureSource> camera_;
+#ifndef _WIN32
+    core::ShmCaptureSource* shmSource_{nullptr};   // camera_ when reading shared memory
+#endif
+    core::CapturedFrame capturedFrame_;
+    cv::Mat frameBgr_;
     core::FaceDetector faceDetector_;
+    core::PosePredictor posePredictor_;
+    core::ResultRecorder recorder_;
+
+    // Motion gate: static frames reuse lastResult_
+    core::MotionGate motionGate_;
+    core::FaceDetector::FaceDetectionResult lastResult_;
+    bool detectionSkipped_{false};
+
+    // Multi-face mode: the tracker replaces faceDetector_ on live frames
+    core::FaceTracker faceTracker_;
+
+    // Frame budget: quality level chosen from measured stage costs
+    std::unique_ptr<core::FrameScheduler> scheduler_;
+    int64_t statsPrintedUs_{0};
+
+    // Replay state
+    core::ResultReplay replay_;
+    std::unique_ptr<core::FileCaptureSource> replayVideo_;
+    uint64_t replayVideoFrames_{0};
+    core::RecordedFrame replayNext_;
+    core::RecordedFrame replayShown_;
+    bool replayPending_{false};   // replayNext_ is decoded but not yet due
+    int64_t replayStartUs_{0};
 
     // Visualization options
     FaceVisualizer::Options visualizerOptions_;
@@ -4,7 +4,7 @@
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
-#include "shader.hpp"
+#include "shader_variants.hpp"
 
 namespace capvision {
 namespace ui {
@@ -15,6 +15,13 @@ struct Vertex {
     glm::vec2 texCoords;
 };
 
+// Per-instance vertex data; the normal matrix is computed on the CPU once
+// per instance rather than per vertex
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat3 normal;
+};
+
 struct Texture {
     unsigned int id;
     std::string type;
@@ -27,15 +34,38 @@ public:
     std::vector<unsigned int> indices;
     std::vector<Texture> textures;
 
+    // diffuseColor is used when the mesh has no diffuse texture; unlit
+    // meshes skip the lighting terms
     Mesh(const std::vector<Vertex>& vertices,
          const std::vector<unsigned int>& indices,
-         const std::vector<Texture>& textures);
+         const std::vector<Texture>& textures,
+         const glm::vec3& diffuseColor = glm::vec3(1.0f),
+         bool lit = true);
+
+    // Level 0 draws every triangle; higher levels draw coarser index lists
+    // built at load time by vertex clustering, over the same vertices
+    static constexpr int kLodCount = 3;
+
+    // Draw `instances` copies in one call with the cheapest shader variant
+    // for this mesh; each copy takes its matrices from the buffer given to
+    // attachInstanceBuffer (attribute locations 3-9)
+    void render(ShaderVariants& shaders, int lod = 0, int instances = 1);
+
+    // Source per-instance InstanceData from `buffer`
+    void attachInstanceBuffer(GLuint buffer);
 
-    void render(Shader& shader);
+    // ShaderVariants feature flags this mesh needs
+    unsigned int features() const { return features_; }
 
 private:
     unsigned int VAO_, VBO_, EBO_;
+    unsigned int lodOffset_[kLodCount]{};   // First index of each level in EBO_
+    unsigned int lodCount_[kLodCount]{};
+    std::vector<std::string> samplerNames_;   // Uniform name of each texture
+    glm::vec3 diffuseColor_;
+    unsigned int features_{0};
     void setupMesh();
+    std::vector<unsigned int> clusteredIndices(int gridSize) const;
 };
 
 } // namespace ui
@@ -6,9 +6,11 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "mesh.hpp"
 #include "shader.hpp"
+#include "texture_cache.hpp"
 
 namespace capvision {
 namespace ui {
@@ -16,20 +18,29 @@ namespace ui {
 class Model3D {
 public:
     explicit Model3D(const char* path);
-    void render(Shader& shader);
+
+    bool empty() const { return meshes_.empty(); }
+
+    // One instanced draw per mesh for `count` copies of the model, one
+    // model matrix each; lod: 0 (full) to Mesh::kLodCount - 1 (coarsest)
+    void render(ShaderVariants& shaders, const glm::mat4* modelMatrices, size_t count, int lod = 0);
 
 private:
     std::vector<Mesh> meshes_;
+    GLuint instanceBuffer_{0};
+    size_t instanceCapacity_{0};   // Instances the buffer holds
+    std::vector<InstanceData> instances_;   // Upload staging, reused
     std::string directory_;
-    std::vector<Texture> texturesLoaded_;
+    // Material texture name -> shared GPU texture; holds the cache references
+    std::unordered_map<std::string, TextureCache::Handle> textures_;
 
     void loadModel(const std::string& path);
+    void loadTextures(const aiScene* scene);
     void processNode(aiNode* node, const aiScene* scene);
     Mesh processMesh(aiMesh* mesh, const aiScene* scene);
     std::vector<Texture> loadMaterialTextures(aiMaterial* mat, 
                                             aiTextureType type,
                                             const std::string& typeName);
-    unsigned int textureFromFile(const char* path, const std::string& directory);
 };
 
 } // namespace ui
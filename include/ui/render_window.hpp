@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QtCore/QThread>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QWindow>
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../../include/core/face_detector.hpp"
+#include "../../include/core/pose_predictor.hpp"
+#include "../../include/core/triple_buffer.hpp"
+#include "../../include/ui/frame_renderer.hpp"
+#include "../../include/ui/video_view.hpp"
+
+namespace capvision {
+namespace ui {
+
+// Renders frames on a dedicated thread with its own GL context, shared with
+// Qt's global share context, and presents them with swapBuffers there, so
+// paints never wait for the GUI event loop and layout, resizes or menus
+// never wait for a paint. Embed it with QWidget::createWindowContainer.
+//
+// updateFrame copies the frame and its faces (already pose-predicted when a
+// predictor is set) into a TripleBuffer slot on the calling thread; the
+// render thread takes the newest one, so a slow consumer drops frames
+// instead of queueing them. Settings reach the thread through atomics.
+// Without new frames or size changes the thread idles rather than redraw.
+class RenderWindow : public QWindow, public VideoView {
+    Q_OBJECT
+
+public:
+    explicit RenderWindow(QWindow* parent = nullptr);
+    ~RenderWindow();
+
+    // Create the context and start the thread; false if the platform
+    // cannot render GL off the GUI thread or the context fails
+    bool start();
+    void stop();
+
+    using VideoView::updateFrame;
+    using VideoView::updateFrameYuyv;
+    void updateFrame(const cv::Mat& frame,
+                     const core::FaceDetector::FaceDetectionResult* faces, size_t count) override;
+    void updateFrameYuyv(const cv::Mat& yuyv,
+                         const core::FaceDetector::FaceDetectionResult* faces, size_t count) override;
+
+    void setPosePredictor(const core::PosePredictor* predictor, double leadMs = 0.0) override;
+    void setFrameTime(int64_t captureUs) override { frameCaptureUs_ = captureUs; }
+    void setCapLod(int lod) override { capLod_.store(lod, std::memory_order_relaxed); }
+
+    // Render-thread CPU time of the last frame, swap excluded
+    double lastPaintMs() const override { return lastPaintMs_.load(std::memory_order_relaxed); }
+
+    void setGpuProfiling(bool enabled) override;
+    bool gpuProfiling() const override { return gpuProfilingRequested_.load(std::memory_order_relaxed); }
+
+protected:
+    void exposeEvent(QExposeEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    // One handoff slot; the buffers are reused from frame to frame
+    struct RenderFrame {
+        cv::Mat image;
+        bool yuv{false};
+        std::vector<core::FaceDetector::FaceDetectionResult> faces;
+    };
+
+    void publish(const cv::Mat& frame, bool yuv,
+                 const core::FaceDetector::FaceDetectionResult* faces, size_t count);
+    void renderLoop();
+    void storeSurfaceSize();
+
+    // GUI thread
+    const core::PosePredictor* posePredictor_{nullptr};
+    double poseLeadMs_{0.0};
+    int64_t frameCaptureUs_{0};
+
+    // Shared between the threads
+    core::TripleBuffer<RenderFrame> mailbox_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> exposed_{false};
+    std::atomic<int> surfaceWidth_{0};
+    std::atomic<int> surfaceHeight_{0};
+    std::atomic<int> capLod_{0};
+    std::atomic<bool> gpuProfilingRequested_{false};
+    std::atomic<double> lastPaintMs_{0.0};
+
+    // Render thread
+    std::unique_ptr<QOpenGLContext> context_;
+    QThread* thread_{nullptr};
+    FrameRenderer renderer_;
+};
+
+} // namespace ui
+} // namespace capvision
@@ -16,11 +16,12 @@ public:
     void use();
     GLuint getProgram() const { return program_; }
 
-    // Utility functions for setting uniforms
-    void setMat4(const std::string& name, const float* value);
-    void setVec3(const std::string& name, float x, float y, float z);
-    void setFloat(const std::string& name, float value);
-    void setInt(const std::string& name, int value);
+    // Utility functions for setting uniforms; names are plain C strings so
+    // per-frame calls do not build a std::string
+    void setMat4(const char* name, const float* value);
+    void setVec3(const char* name, float x, float y, float z);
+    void setFloat(const char* name, float value);
+    void setInt(const char* name, int value);
 
 private:
     GLuint program_{0};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "shader.hpp"
+
+namespace capvision {
+namespace ui {
+
+// Specialised programs compiled from one vertex/fragment source pair. Each
+// feature flag becomes a #define after the #version line, so a variant only
+// carries the work its meshes need; untextured meshes do not sample and
+// unlit ones skip the lighting terms.
+//
+// Frame uniforms are uploaded to a variant the first time it is used in a
+// frame, not on every draw.
+class ShaderVariants {
+public:
+    enum Feature : unsigned int {
+        kTextured = 1u << 0,   // TEXTURED: sample texture_diffuse1, else diffuseColor
+        kLit = 1u << 1,        // LIT: ambient + diffuse lighting
+        kAllFeatures = kTextured | kLit
+    };
+
+    struct FrameUniforms {
+        glm::mat4 projection{1.0f};
+        glm::mat4 view{1.0f};
+        glm::vec3 lightPos{0.0f, 0.0f, 2.0f};
+        glm::vec3 viewPos{0.0f, 0.0f, 2.0f};
+    };
+
+    // Sources must start with their #version line
+    ShaderVariants(std::string vertexSource, std::string fragmentSource);
+
+    // Compile every variant now rather than on first use; false if any fails
+    bool compileAll();
+
+    // Uniforms shared by all draws until the next beginFrame
+    void beginFrame(const FrameUniforms& uniforms);
+
+    // Bind the variant for features, compiling it on first use. Null if it
+    // does not compile.
+    Shader* use(unsigned int features);
+
+    // "#define TEXTURED\n..." for the flags set in features
+    static std::string defines(unsigned int features);
+
+private:
+    struct Variant {
+        std::unique_ptr<Shader> shader;
+        bool failed{false};
+        uint64_t frame{0};   // Last frame whose uniforms were uploaded
+    };
+
+    Variant& variant(unsigned int features);
+
+    std::string vertexSource_;
+    std::string fragmentSource_;
+    std::array<Variant, kAllFeatures + 1> variants_;
+    FrameUniforms uniforms_;
+    uint64_t frame_{0};
+    unsigned int bound_{~0u};   // Variant bound by the last use() this frame
+};
+
+} // namespace ui
+} // namespace capvision
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../core/thread_pool.hpp"
+
+namespace capvision {
+namespace ui {
+
+// GPU textures shared by every loaded model, keyed by a hash of the image
+// file's bytes, so caps that ship the same fabric or logo under different
+// names or directories share one texture. Files are read and decoded on a
+// worker pool; only the upload runs on the calling GL thread.
+//
+// Handles are reference counted. When the last one goes, the texture is
+// queued and deleted by the next acquire() or collect() on the GL thread.
+// A cache must outlive the handles it hands out.
+class TextureCache {
+public:
+    struct CachedTexture {
+        GLuint id{0};
+        int width{0};
+        int height{0};
+        uint64_t hash{0};
+    };
+    using Handle = std::shared_ptr<const CachedTexture>;
+
+    static TextureCache& global();
+
+    // pool == nullptr decodes on the calling thread
+    explicit TextureCache(std::shared_ptr<core::ThreadPool> pool = nullptr);
+    ~TextureCache();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // One handle per path, null where the file cannot be read or decoded.
+    // Needs a current GL context.
+    std::vector<Handle> acquire(const std::vector<std::string>& paths);
+
+    // Delete textures no handle refers to any more. Needs a current GL context.
+    void collect();
+
+    // Textures currently held
+    size_t size() const;
+
+private:
+    void release(const CachedTexture* texture);
+
+    std::shared_ptr<core::ThreadPool> pool_;
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, std::weak_ptr<const CachedTexture>> textures_;
+    std::vector<GLuint> released_;   // Waiting for the GL thread
+};
+
+} // namespace ui
+} // namespace capvision
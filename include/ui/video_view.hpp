@@ -0,0 +1,53 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include "../../include/core/face_detector.hpp"
+#include "../../include/core/pose_predictor.hpp"
+
+namespace capvision {
+namespace ui {
+
+// Where MainWindow sends its frames: OpenGLWidget paints them on the GUI
+// thread, RenderWindow on a render thread of its own. Every call comes
+// from the GUI thread.
+class VideoView {
+public:
+    virtual ~VideoView() = default;
+
+    // Every face in the frame gets a cap, drawn in one instanced call
+    virtual void updateFrame(const cv::Mat& frame,
+                             const core::FaceDetector::FaceDetectionResult* faces, size_t count) = 0;
+    void updateFrame(const cv::Mat& frame, const core::FaceDetector::FaceDetectionResult& face) {
+        updateFrame(frame, &face, 1);
+    }
+
+    // Packed YUYV frame (CV_8UC2); converted to RGB by the video shader
+    virtual void updateFrameYuyv(const cv::Mat& yuyv,
+                                 const core::FaceDetector::FaceDetectionResult* faces, size_t count) = 0;
+    void updateFrameYuyv(const cv::Mat& yuyv, const core::FaceDetector::FaceDetectionResult& face) {
+        updateFrameYuyv(yuyv, &face, 1);
+    }
+
+    // While predictor has a face, the cap is placed from its pose
+    // extrapolated to the shown frame's capture time plus leadMs, rather
+    // than from the faces passed with the frame; nullptr turns this off
+    virtual void setPosePredictor(const core::PosePredictor* predictor, double leadMs = 0.0) = 0;
+
+    // Capture time (steady clock) of the frame being passed to updateFrame
+    virtual void setFrameTime(int64_t captureUs) = 0;
+
+    // Cap mesh detail, 0 (full) to Mesh::kLodCount - 1
+    virtual void setCapLod(int lod) = 0;
+
+    // CPU time of the last frame drawn, in milliseconds
+    virtual double lastPaintMs() const = 0;
+
+    // GPU timer queries around the upload, video and cap passes, published
+    // as gpu.*_ms; applied at the next paint, so callable at any time
+    virtual void setGpuProfiling(bool enabled) = 0;
+    virtual bool gpuProfiling() const = 0;
+};
+
+} // namespace ui
+} // namespace capvision
@@ -0,0 +1,285 @@
+#include "../../include/core/allocation_tracker.hpp"
+#include "../../include/core/instrumentation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#ifdef CAPVISION_TRACK_ALLOCATIONS
+#include <opencv2/core.hpp>
+#endif
+
+namespace capvision {
+namespace core {
+
+#ifdef CAPVISION_TRACK_ALLOCATIONS
+
+namespace {
+
+// Everything here is constant-initialized: operator new runs during static
+// initialization and must not depend on anything being constructed
+struct Slot {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+Slot g_slots[AllocationTracker::kMaxStages];   // Slot 0 is "other"
+std::atomic<int> g_slot_count{1};
+std::mutex g_register_mutex;
+thread_local int t_stage = 0;
+
+const char* stageName(int slot) {
+    return slot == 0 ? "other" : g_slots[slot].name.load(std::memory_order_acquire);
+}
+
+int findStage(const char* name, int count) {
+    for (int i = 1; i < count; ++i) {
+        const char* existing = g_slots[i].name.load(std::memory_order_acquire);
+        if (existing == name || std::strcmp(existing, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Slot of a stage, registered on first use; "other" once the table is full
+int stageSlot(const char* name) {
+    int slot = findStage(name, g_slot_count.load(std::memory_order_acquire));
+    if (slot >= 0) {
+        return slot;
+    }
+    std::lock_guard<std::mutex> lock(g_register_mutex);
+    const int count = g_slot_count.load(std::memory_order_relaxed);
+    slot = findStage(name, count);
+    if (slot >= 0) {
+        return slot;
+    }
+    if (count >= static_cast<int>(AllocationTracker::kMaxStages)) {
+        return 0;
+    }
+    g_slots[count].name.store(name, std::memory_order_release);
+    g_slot_count.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void countAllocation(size_t bytes) {
+    Slot& slot = g_slots[t_stage];
+    slot.allocations.fetch_add(1, std::memory_order_relaxed);
+    slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void* allocate(size_t size) {
+    countAllocation(size);
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        if (void* p = std::malloc(size)) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocateAligned(size_t size, std::align_val_t alignment) {
+    countAllocation(size);
+    const size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc wants a multiple of the alignment
+    size = (std::max<size_t>(size, 1) + align - 1) / align * align;
+    while (true) {
+#ifdef _MSC_VER
+        if (void* p = _aligned_malloc(size, align)) {
+#else
+        if (void* p = std::aligned_alloc(align, size)) {
+#endif
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void freeAligned(void* p) {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+// cv::Mat buffers come from cv::fastMalloc, not operator new; this counts
+// them and leaves the allocation itself to OpenCV's standard allocator
+class CountingMatAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+        cv::UMatData* u = cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage);
+        if (u && !data) {
+            countAllocation(u->size);
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+        return cv::Mat::getStdAllocator()->allocate(u, flags, usage);
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        cv::Mat::getStdAllocator()->deallocate(u);
+    }
+};
+
+CountingMatAllocator g_mat_allocator;
+const bool g_mat_allocator_installed = (cv::Mat::setDefaultAllocator(&g_mat_allocator), true);
+
+} // namespace
+
+AllocationTracker::Scope::Scope(const char* stage) : previous_(t_stage) {
+    t_stage = stageSlot(stage);
+}
+
+AllocationTracker::Scope::~Scope() {
+    t_stage = previous_;
+}
+
+std::vector<std::pair<std::string, AllocationTracker::Counts>> AllocationTracker::snapshot() {
+    std::vector<std::pair<std::string, Counts>> result;
+    const int count = g_slot_count.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        Counts counts;
+        counts.allocations = g_slots[i].allocations.load(std::memory_order_relaxed);
+        counts.bytes = g_slots[i].bytes.load(std::memory_order_relaxed);
+        result.emplace_back(stageName(i), counts);
+    }
+    return result;
+}
+
+AllocationTracker::Counts AllocationTracker::total() {
+    Counts counts;
+    const int count = g_slot_count.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        counts.allocations += g_slots[i].allocations.load(std::memory_order_relaxed);
+        counts.bytes += g_slots[i].bytes.load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+void AllocationTracker::publish() {
+    static std::mutex mutex;
+    static uint64_t published[kMaxStages];
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Names are formatted on the stack; Instrumentation only allocates the
+    // first time it sees one
+    char name[64];
+    uint64_t frame_total = 0;
+    const int count = g_slot_count.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        const uint64_t now = g_slots[i].allocations.load(std::memory_order_relaxed);
+        const uint64_t delta = now - published[i];
+        published[i] = now;
+        frame_total += delta;
+        std::snprintf(name, sizeof(name), "alloc.%s", stageName(i));
+        Instrumentation::global().set(name, static_cast<double>(delta));
+    }
+    Instrumentation::global().set("alloc.total", static_cast<double>(frame_total));
+}
+
+#else
+
+std::vector<std::pair<std::string, AllocationTracker::Counts>> AllocationTracker::snapshot() {
+    return {};
+}
+
+AllocationTracker::Counts AllocationTracker::total() {
+    return Counts{};
+}
+
+void AllocationTracker::publish() {
+}
+
+#endif
+
+} // namespace core
+} // namespace capvision
+
+#ifdef CAPVISION_TRACK_ALLOCATIONS
+
+// Replacing these in the library is enough: the linker takes them from here
+// before the C++ runtime's
+void* operator new(std::size_t size) {
+    return capvision::core::allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return capvision::core::allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return capvision::core::allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return capvision::core::allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return capvision::core::allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return capvision::core::allocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    capvision::core::freeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    capvision::core::freeAligned(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    capvision::core::freeAligned(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    capvision::core::freeAligned(p);
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include "../../include/core/capture_source.hpp"
+#include "../../include/core/v4l2_capture_source.hpp"
+#include <chrono>
+
+namespace capvision {
+namespace core {
+
+int64_t steadyNowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool convertToBgr(const CapturedFrame& frame, cv::Mat& bgr) {
+    if (frame.image.empty()) {
+        return false;
+    }
+
+    switch (frame.format) {
+    case PixelFormat::BGR:
+        bgr = frame.image;
+        return true;
+    case PixelFormat::YUYV:
+        cv::cvtColor(frame.image, bgr, cv::COLOR_YUV2BGR_YUYV);
+        return true;
+    case PixelFormat::MJPEG:
+        bgr = cv::imdecode(frame.image, cv::IMREAD_COLOR);
+        return !bgr.empty();
+    }
+    return false;
+}
+
+OpenCvCaptureSource::OpenCvCaptureSource(int deviceIndex)
+    : device_index_(deviceIndex) {
+}
+
+OpenCvCaptureSource::~OpenCvCaptureSource() = default;
+
+bool OpenCvCaptureSource::open() {
+    if (!capture_.open(device_index_)) {
+        return false;
+    }
+
+    // Keep as few frames as the driver allows queued behind the live one
+    capture_.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    return true;
+}
+
+bool OpenCvCaptureSource::isOpened() const {
+    return capture_.isOpened();
+}
+
+void OpenCvCaptureSource::close() {
+    capture_.release();
+}
+
+bool OpenCvCaptureSource::read(CapturedFrame& frame) {
+    if (!capture_.grab()) {
+        return false;
+    }
+
+    // grab() returns as soon as the frame is captured, so this is the closest
+    // timestamp VideoCapture can provide
+    frame.timestamp_us = steadyNowMicros();
+    if (!capture_.retrieve(frame.image)) {
+        return false;
+    }
+
+    frame.format = PixelFormat::BGR;
+    frame.sequence = sequence_++;
+    return true;
+}
+
+std::unique_ptr<CaptureSource> createCameraSource(int deviceIndex) {
+#ifdef __linux__
+    V4l2CaptureSource::Options options;
+    options.device = "/dev/video" + std::to_string(deviceIndex);
+    auto source = std::make_unique<V4l2CaptureSource>(options);
+    if (source->open()) {
+        return source;
+    }
+#endif
+
+    auto fallback = std::make_unique<OpenCvCaptureSource>(deviceIndex);
+    fallback->open();
+    return fallback;
+}
+
+} // namespace core
+} // namespace capvision
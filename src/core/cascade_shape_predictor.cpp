@@ -0,0 +1,101 @@
+#include "../../include/core/cascade_shape_predictor.hpp"
+#include <cmath>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+// Share of the cascade kept at each quality level, 0 (fastest) to 4 (full)
+constexpr double kDepthFraction[] = {0.4, 0.55, 0.7, 0.85, 1.0};
+constexpr double kTreeFraction[] = {0.5, 0.75, 1.0, 1.0, 1.0};
+
+// Weight of the newest sample in the running level cost
+constexpr double kCostSmoothing = 0.1;
+
+} // namespace
+
+CascadeShapePredictor::Quality CascadeShapePredictor::Quality::level(int qualityLevel,
+                                                                     const CascadeShapePredictor& predictor) {
+    const int q = std::max(0, std::min(qualityLevel, kMaxQualityLevel));
+    Quality quality;
+    if (q < kMaxQualityLevel) {
+        quality.cascade_depth = std::max(1ul, static_cast<unsigned long>(
+            std::ceil(predictor.numLevels() * kDepthFraction[q])));
+        quality.trees_per_level = std::max(1ul, static_cast<unsigned long>(
+            std::ceil(predictor.treesPerLevel() * kTreeFraction[q])));
+    }
+    return quality;
+}
+
+CascadeShapePredictor::Quality CascadeShapePredictor::qualityForBudget(double budgetMs,
+                                                                      const Workspace& workspace) const {
+    Quality quality;
+    if (workspace.level_cost_ms <= 0.0) {
+        return quality;
+    }
+    const double levels = std::floor(budgetMs / workspace.level_cost_ms);
+    quality.cascade_depth = static_cast<unsigned long>(
+        std::max(1.0, std::min(levels, static_cast<double>(numLevels()))));
+    return quality;
+}
+
+void CascadeShapePredictor::recordCost(Workspace& workspace, double ms, unsigned long levels,
+                                       unsigned long trees) const {
+    if (levels == 0 || trees == 0) {
+        return;
+    }
+
+    // Tree evaluation dominates, so scale partial levels up to a full one
+    const double tree_fraction = static_cast<double>(trees) / treesPerLevel();
+    const double level_ms = ms / (levels * tree_fraction);
+    double& cost = workspace.level_cost_ms;
+    cost = cost <= 0.0 ? level_ms : cost + kCostSmoothing * (level_ms - cost);
+}
+
+bool CascadeShapePredictor::flatten(bool releaseNested) {
+    if (!flat_.build(initial_shape_, forests_, anchor_idx_, deltas_)) {
+        return false;
+    }
+    if (releaseNested) {
+        std::vector<std::vector<dlib::impl::regression_tree>>().swap(forests_);
+        std::vector<std::vector<unsigned long>>().swap(anchor_idx_);
+        std::vector<std::vector<dlib::vector<float, 2>>>().swap(deltas_);
+    }
+    return true;
+}
+
+size_t CascadeShapePredictor::memoryBytes() const {
+    size_t bytes = initial_shape_.size() * sizeof(float);
+    for (size_t l = 0; l < forests_.size(); ++l) {
+        for (const auto& tree : forests_[l]) {
+            bytes += sizeof(tree) + tree.splits.capacity() * sizeof(dlib::impl::split_feature) +
+                     tree.leaf_values.capacity() * sizeof(dlib::matrix<float, 0, 1>);
+            for (const auto& leaf : tree.leaf_values) {
+                bytes += leaf.size() * sizeof(float);
+            }
+        }
+        bytes += anchor_idx_[l].capacity() * sizeof(unsigned long) +
+                 deltas_[l].capacity() * sizeof(dlib::vector<float, 2>);
+    }
+    return bytes + flat_.memoryBytes();
+}
+
+void deserialize(CascadeShapePredictor& item, std::istream& in) {
+    // Same layout as dlib::shape_predictor's serialize()
+    int version = 0;
+    dlib::deserialize(version, in);
+    if (version != 1) {
+        throw dlib::serialization_error("Unexpected version found while deserializing a shape_predictor.");
+    }
+    dlib::deserialize(item.initial_shape_, in);
+    dlib::deserialize(item.forests_, in);
+    dlib::deserialize(item.anchor_idx_, in);
+    dlib::deserialize(item.deltas_, in);
+    item.num_levels_ = static_cast<unsigned long>(item.forests_.size());
+    item.trees_per_level_ = item.forests_.empty() ? 0 : static_cast<unsigned long>(item.forests_[0].size());
+    item.flat_ = FlatShapeModel();
+}
+
+} // namespace core
+} // namespace capvision
@@ -1,51 +1,105 @@
 #include "../../include/core/face_detector.hpp"
-#include <dlib/opencv.h>
+#include <array>
+#include <chrono>
+#include <cmath>
 
 namespace capvision {
 namespace core {
 
-FaceDetector::FaceDetector() : detector_(dlib::get_frontal_face_detector()) {
-    // Initialize 3D model points for pose estimation
-    model_points_3d_ = {
-        cv::Point3d(0.0, 0.0, 0.0),          // Nose tip
-        cv::Point3d(0.0, -330.0, -65.0),     // Chin
-        cv::Point3d(-225.0, 170.0, -135.0),  // Left eye corner
-        cv::Point3d(225.0, 170.0, -135.0),   // Right eye corner
-        cv::Point3d(-150.0, -150.0, -125.0), // Left mouth corner
-        cv::Point3d(150.0, -150.0, -125.0)   // Right mouth corner
-    };
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point& since) {
+    const auto now = Clock::now();
+    const double ms = std::chrono::duration<double, std::milli>(now - since).count();
+    since = now;
+    return ms;
+}
+
+} // namespace
+
+FaceDetector::FaceDetector() {
+    // Scan pyramid levels on all cores; the calling thread takes part too
+    const unsigned int cores = std::thread::hardware_concurrency();
+    setDetectionPool(cores > 1 ? std::make_shared<ThreadPool>(cores - 1) : nullptr);
 }
 
 FaceDetector::~FaceDetector() = default;
 
-bool FaceDetector::initialize() {
-    try {
-        // Load face landmark detector
-        dlib::deserialize(model_path_) >> shape_predictor_;
-        initialized_ = true;
-        return true;
+void FaceDetector::setDetectionPool(std::shared_ptr<ThreadPool> pool) {
+    detection_pool_ = std::move(pool);
+    if (models_) {
+        scanner_ = std::make_unique<ParallelFaceScanner>(models_->face_detector, detection_pool_);
     }
-    catch (const dlib::serialization_error& e) {
-        std::cerr << "Failed to load shape predictor model: " << e.what() << std::endl;
+}
+
+bool FaceDetector::initialize(bool flatLandmarkModel) {
+    return initialize(FaceModels::shared(model_path_, flatLandmarkModel));
+}
+
+bool FaceDetector::initialize(std::shared_ptr<const FaceModels> models) {
+    if (!models) {
         return false;
     }
+    models_ = std::move(models);
+    scanner_ = std::make_unique<ParallelFaceScanner>(models_->face_detector, detection_pool_);
+    landmark_workspace_ = CascadeShapePredictor::Workspace{};
+    resetLandmarkWarmStart();
+    has_tracked_face_ = false;
+    initialized_ = true;
+    return true;
+}
+
+FaceDetector::LandmarkQuality FaceDetector::landmarkQualityLevel(int level) const {
+    return models_ ? LandmarkQuality::level(level, models_->landmarks) : LandmarkQuality{};
+}
+
+void FaceDetector::setLandmarkWarmStart(const WarmStart& warmStart) {
+    warm_start_ = warmStart;
+    resetLandmarkWarmStart();
 }
 
 FaceDetector::FaceDetectionResult FaceDetector::detectFace(const cv::Mat& frame) {
+    return detect(frame, nullptr);
+}
+
+FaceDetector::FaceDetectionResult FaceDetector::detectFace(const cv::Mat& frame,
+                                                           const LandmarkQuality& quality) {
+    return detect(frame, &quality);
+}
+
+FaceDetector::FaceDetectionResult FaceDetector::detect(const cv::Mat& frame,
+                                                       const LandmarkQuality* quality) {
     FaceDetectionResult result;
     result.success = false;
+    timings_ = StageTimings{};
     
     if (!initialized_ || frame.empty()) {
         return result;
     }
 
-    // Convert OpenCV Mat to dlib matrix
-    dlib::matrix<dlib::rgb_pixel> dlib_img;
-    dlib::assign_image(dlib_img, dlib::cv_image<dlib::bgr_pixel>(frame));
-
-    // Detect faces
-    std::vector<dlib::rectangle> faces = detector_(dlib_img);
+    // Convert the frame to a grayscale pyramid in one pass
+    auto stage_start = Clock::now();
+    pyramid_.build(frame, scanner_->countPyramidLevels(dlib::rectangle(frame.cols, frame.rows)));
+    timings_.pyramid_ms = elapsedMs(stage_start);
+
+    // Detect faces, or reuse the tracked box between scans; faces_ keeps
+    // its capacity, so tracked frames do not allocate here
+    std::vector<dlib::rectangle>& faces = faces_;
+    faces.clear();
+    const bool scan = !has_tracked_face_ || frames_since_scan_ + 1 >= detection_interval_;
+    if (scan) {
+        faces = (*scanner_)(pyramid_, 0, detection_first_level_);
+        frames_since_scan_ = 0;
+    } else {
+        faces.push_back(tracked_face_);
+        ++frames_since_scan_;
+    }
+    timings_.detection_ms = elapsedMs(stage_start);
     if (faces.empty()) {
+        has_tracked_face_ = false;
+        resetLandmarkWarmStart();
         return result;
     }
 
@@ -53,54 +107,75 @@ FaceDetector::FaceDetectionResult FaceDetector::detectFace(const cv::Mat& frame)
     auto face = faces[0];
     result.face_rect = cv::Rect(face.left(), face.top(), face.width(), face.height());
 
-    // Detect landmarks
-    auto shape = shape_predictor_(dlib_img, face);
-    result.landmarks.reserve(68);
+    // Detect landmarks, within what is left of the frame budget when one is set
+    const CascadeShapePredictor& shape_predictor = models_->landmarks;
+    LandmarkQuality landmark_quality = quality ? *quality : landmark_quality_;
+    if (!quality && landmark_budget_ms_ > 0.0) {
+        const double remaining_ms = landmark_budget_ms_ - timings_.pyramid_ms - timings_.detection_ms;
+        landmark_quality = shape_predictor.qualityForBudget(remaining_ms, landmark_workspace_);
+    }
 
-    // Convert landmarks to OpenCV format
-    for (unsigned int i = 0; i < shape.num_parts(); ++i) {
-        auto point = shape.part(i);
-        result.landmarks.emplace_back(point.x(), point.y());
+    // Warm start from the previous frame while it is the same face
+    bool warm = false;
+    unsigned long start_level = 0;
+    if (warm_start_.enabled && previous_shape_.num_parts() > 0 &&
+        (warm_start_.refresh_interval <= 0 || warm_frames_ < warm_start_.refresh_interval)) {
+        const dlib::rectangle& last = previous_shape_.get_rect();
+        const double limit = warm_start_.max_box_change * last.width();
+        const dlib::point shift = dlib::center(face) - dlib::center(last);
+        warm = std::abs(shift.x()) <= limit && std::abs(shift.y()) <= limit &&
+               std::abs(static_cast<double>(face.width()) - last.width()) <= limit;
+        start_level = warm_start_.start_level > 0
+            ? warm_start_.start_level : shape_predictor.numLevels() / 2;
     }
 
-    // Initialize camera matrix if needed
-    if (camera_matrix_.empty()) {
-        float focal_length = frame.cols;
-        cv::Point2d center(frame.cols/2, frame.rows/2);
-        camera_matrix_ = (cv::Mat_<double>(3, 3) << 
-            focal_length, 0, center.x,
-            0, focal_length, center.y,
-            0, 0, 1);
+    dlib::full_object_detection shape;
+    if (warm) {
+        // A budgeted depth counts levels actually run, which now begin later
+        if (!quality && landmark_budget_ms_ > 0.0 && landmark_quality.cascade_depth > 0) {
+            landmark_quality.cascade_depth += start_level;
+        }
+        shape = shape_predictor.refine(pyramid_.level(0), face, previous_shape_, start_level,
+                                       landmark_workspace_, landmark_quality);
+        ++warm_frames_;
+    } else {
+        shape = shape_predictor(pyramid_.level(0), face, landmark_workspace_, landmark_quality);
+        warm_frames_ = 0;
+    }
+    if (warm_start_.enabled) {
+        previous_shape_ = shape;
     }
 
-    // Get specific facial landmarks for pose estimation
-    std::vector<cv::Point2d> image_points;
-    image_points.push_back(result.landmarks[30]);    // Nose tip
-    image_points.push_back(result.landmarks[8]);     // Chin
-    image_points.push_back(result.landmarks[36]);    // Left eye corner
-    image_points.push_back(result.landmarks[45]);    // Right eye corner
-    image_points.push_back(result.landmarks[48]);    // Left mouth corner
-    image_points.push_back(result.landmarks[54]);    // Right mouth corner
+    // Box for the frames that skip the scan
+    if (detection_interval_ > 1 && shape.num_parts() > 0) {
+        dlib::dpoint centroid;
+        for (unsigned long i = 0; i < shape.num_parts(); ++i) {
+            centroid += shape.part(i);
+        }
+        centroid /= shape.num_parts();
+        if (scan) {
+            scanned_face_ = face;
+            scanned_centroid_ = centroid;
+        }
+        tracked_face_ = dlib::translate_rect(scanned_face_, dlib::point(centroid - scanned_centroid_));
+        has_tracked_face_ = true;
+    } else {
+        has_tracked_face_ = false;
+    }
 
+    // Convert landmarks to OpenCV format
+    for (unsigned int i = 0; i < shape.num_parts(); ++i) {
+        auto point = shape.part(i);
+        result.landmarks.emplace_back(static_cast<float>(point.x()), static_cast<float>(point.y()));
+    }
+    timings_.landmarks_ms = elapsedMs(stage_start);
 
     // Solve for pose
-    cv::Mat rvec, tvec;
-    cv::solvePnP(model_points_3d_, image_points, camera_matrix_, dist_coeffs_, 
-                 rvec, tvec, false, cv::SOLVEPNP_ITERATIVE);
-
-    // Convert rotation vector to rotation matrix
-    cv::Rodrigues(rvec, result.rotation_matrix);
-
-
-    // Store rotation vector directly (in degrees)
-    // This gives us rotation around X, Y, Z axes directly
-    result.euler_angles = cv::Vec3d(
-        rvec.at<double>(0) * 180.0 / CV_PI,
-        rvec.at<double>(1) * 180.0 / CV_PI,
-        rvec.at<double>(2) * 180.0 / CV_PI
-    );
+    const bool posed = head_pose_.estimate(result.landmarks, frame.size(),
+                                           result.rotation_matrix, result.euler_angles);
+    timings_.pose_ms = elapsedMs(stage_start);
 
-    result.success = true;
+    result.success = posed;
     return result;
 }
 
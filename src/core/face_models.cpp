@@ -0,0 +1,43 @@
+#include "../../include/core/face_models.hpp"
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace capvision {
+namespace core {
+
+std::shared_ptr<const FaceModels> FaceModels::load(const std::string& landmarkPath, bool flatLandmarkModel) {
+    auto models = std::make_shared<FaceModels>();
+    models->face_detector = dlib::get_frontal_face_detector();
+    try {
+        // Load face landmark detector
+        dlib::deserialize(landmarkPath) >> models->landmarks;
+    }
+    catch (const dlib::serialization_error& e) {
+        std::cerr << "Failed to load shape predictor model: " << e.what() << std::endl;
+        return nullptr;
+    }
+    if (flatLandmarkModel && !models->landmarks.flatten()) {
+        std::cerr << "Landmark model cannot be flattened, using dlib's layout" << std::endl;
+    }
+    return models;
+}
+
+std::shared_ptr<const FaceModels> FaceModels::shared(const std::string& landmarkPath, bool flatLandmarkModel) {
+    static std::mutex mutex;
+    static std::map<std::pair<std::string, bool>, std::weak_ptr<const FaceModels>> loaded;
+
+    // Held across the load so concurrent first callers do not each read the file
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = loaded[{landmarkPath, flatLandmarkModel}];
+    std::shared_ptr<const FaceModels> models = slot.lock();
+    if (!models) {
+        models = load(landmarkPath, flatLandmarkModel);
+        slot = models;
+    }
+    return models;
+}
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,182 @@
+#include "../../include/core/face_protocol.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace capvision {
+namespace core {
+namespace protocol {
+
+namespace {
+
+template <typename T>
+void append(std::vector<uint8_t>& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool take(const uint8_t*& data, const uint8_t* end, T& value) {
+    if (static_cast<size_t>(end - data) < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return true;
+}
+
+void appendText(std::vector<uint8_t>& out, const char* text) {
+    out.insert(out.end(), text, text + std::strlen(text));
+}
+
+void appendNumber(std::vector<uint8_t>& out, double value) {
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    out.insert(out.end(), buffer, buffer + length);
+}
+
+} // namespace
+
+void encodeResultBinary(const FaceDetector::FaceDetectionResult& result, std::vector<uint8_t>& out) {
+    out.clear();
+    append<uint8_t>(out, result.success ? 1 : 0);
+    append<int32_t>(out, result.face_rect.x);
+    append<int32_t>(out, result.face_rect.y);
+    append<int32_t>(out, result.face_rect.width);
+    append<int32_t>(out, result.face_rect.height);
+
+    append<uint16_t>(out, static_cast<uint16_t>(result.landmarks.size()));
+    for (const auto& point : result.landmarks) {
+        append<float>(out, point.x);
+        append<float>(out, point.y);
+    }
+
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            append<double>(out, result.rotation_matrix(r, c));
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        append<double>(out, result.euler_angles[i]);
+    }
+}
+
+bool decodeResultBinary(const uint8_t* data, size_t size, FaceDetector::FaceDetectionResult& result) {
+    const uint8_t* end = data + size;
+
+    uint8_t success;
+    int32_t rect[4];
+    uint16_t count;
+    if (!take(data, end, success) || !take(data, end, rect) || !take(data, end, count) ||
+        count > LandmarkArray::kCapacity) {
+        return false;
+    }
+    result.success = success != 0;
+    result.face_rect = cv::Rect(rect[0], rect[1], rect[2], rect[3]);
+
+    result.landmarks.resize(count);
+    for (auto& point : result.landmarks) {
+        if (!take(data, end, point.x) || !take(data, end, point.y)) {
+            return false;
+        }
+    }
+
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            if (!take(data, end, result.rotation_matrix(r, c))) {
+                return false;
+            }
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (!take(data, end, result.euler_angles[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void encodeResultJson(const FaceDetector::FaceDetectionResult& result, std::vector<uint8_t>& out) {
+    out.clear();
+    appendText(out, result.success ? "{\"success\":true,\"face_rect\":[" : "{\"success\":false,\"face_rect\":[");
+    appendNumber(out, result.face_rect.x);
+    appendText(out, ",");
+    appendNumber(out, result.face_rect.y);
+    appendText(out, ",");
+    appendNumber(out, result.face_rect.width);
+    appendText(out, ",");
+    appendNumber(out, result.face_rect.height);
+
+    appendText(out, "],\"landmarks\":[");
+    for (size_t i = 0; i < result.landmarks.size(); ++i) {
+        appendText(out, i == 0 ? "[" : ",[");
+        appendNumber(out, result.landmarks[i].x);
+        appendText(out, ",");
+        appendNumber(out, result.landmarks[i].y);
+        appendText(out, "]");
+    }
+
+    appendText(out, "],\"rotation_matrix\":[");
+    for (int i = 0; i < 9; ++i) {
+        if (i > 0) {
+            appendText(out, ",");
+        }
+        appendNumber(out, result.rotation_matrix.val[i]);
+    }
+
+    appendText(out, "],\"euler_angles\":[");
+    for (int i = 0; i < 3; ++i) {
+        if (i > 0) {
+            appendText(out, ",");
+        }
+        appendNumber(out, result.euler_angles[i]);
+    }
+    appendText(out, "]}");
+}
+
+bool readFully(int fd, void* data, size_t size) {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        const auto received = recv(fd, bytes, static_cast<int>(size), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* data, size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+#ifdef MSG_NOSIGNAL
+        const auto sent = send(fd, bytes, size, MSG_NOSIGNAL);
+#else
+        const auto sent = send(fd, bytes, static_cast<int>(size), 0);
+#endif
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+} // namespace protocol
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,360 @@
+#include "../../include/core/face_server.hpp"
+
+#ifndef _WIN32
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+size_t bytesPerPixel(protocol::FrameEncoding encoding) {
+    switch (encoding) {
+    case protocol::FrameEncoding::Gray: return 1;
+    case protocol::FrameEncoding::Yuyv: return 2;
+    case protocol::FrameEncoding::Bgr: return 3;
+    default: return 0;
+    }
+}
+
+int matType(protocol::FrameEncoding encoding) {
+    switch (encoding) {
+    case protocol::FrameEncoding::Gray: return CV_8UC1;
+    case protocol::FrameEncoding::Yuyv: return CV_8UC2;
+    default: return CV_8UC3;
+    }
+}
+
+} // namespace
+
+FaceServer::FaceServer(const Config& config)
+    : config_(config) {
+    if (config_.worker_count == 0) {
+        config_.worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    config_.max_batch = std::max<size_t>(1, config_.max_batch);
+}
+
+FaceServer::~FaceServer() {
+    stop();
+}
+
+bool FaceServer::start() {
+    if (running_) {
+        return false;
+    }
+
+    // The dispatcher runs batch items too, so it needs a detector of its own
+    const size_t helper_count = config_.worker_count > 1 ? config_.worker_count - 1 : 0;
+    detectors_.clear();
+    for (size_t i = 0; i < helper_count + 1; ++i) {
+        auto detector = std::make_unique<FaceDetector>();
+        detector->setDetectionPool(nullptr);
+        if (!detector->initialize()) {
+            return false;
+        }
+        detectors_.push_back(std::move(detector));
+    }
+    pool_ = helper_count > 0 ? std::make_shared<ThreadPool>(helper_count) : nullptr;
+
+    if (!config_.unix_socket_path.empty()) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (config_.unix_socket_path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "FaceServer: socket path too long" << std::endl;
+            return false;
+        }
+        std::strcpy(address.sun_path, config_.unix_socket_path.c_str());
+        unlink(address.sun_path);
+
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0 ||
+            bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            std::cerr << "FaceServer: cannot bind " << config_.unix_socket_path << std::endl;
+            stop();
+            return false;
+        }
+    } else {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(config_.tcp_port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (listen_fd_ < 0 ||
+            bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            std::cerr << "FaceServer: cannot bind 127.0.0.1:" << config_.tcp_port << std::endl;
+            stop();
+            return false;
+        }
+    }
+
+    if (listen(listen_fd_, 16) < 0) {
+        stop();
+        return false;
+    }
+
+    running_ = true;
+    accept_thread_ = std::thread(&FaceServer::acceptLoop, this);
+    dispatch_thread_ = std::thread(&FaceServer::dispatchLoop, this);
+    return true;
+}
+
+void FaceServer::stop() {
+    running_ = false;
+
+    if (listen_fd_ >= 0) {
+        shutdown(listen_fd_, SHUT_RDWR);
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    if (accept_thread_.joinable()) {
+        accept_thread_.join();
+    }
+
+    // Unblock the readers; sockets close once no queued request refers to them
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (auto& connection : connections_) {
+            shutdown(connection->fd, SHUT_RDWR);
+        }
+        for (auto& connection : connections_) {
+            if (connection->reader.joinable()) {
+                connection->reader.join();
+            }
+        }
+        connections_.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+    }
+    queue_ready_.notify_all();
+    if (dispatch_thread_.joinable()) {
+        dispatch_thread_.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queue_.clear();
+    }
+    pool_.reset();
+
+    if (!config_.unix_socket_path.empty()) {
+        unlink(config_.unix_socket_path.c_str());
+    }
+}
+
+FaceServer::Connection::~Connection() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+void FaceServer::acceptLoop() {
+    while (running_) {
+        const int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            if (!running_) {
+                return;
+            }
+            continue;
+        }
+
+        auto connection = std::make_shared<Connection>();
+        connection->fd = fd;
+
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+
+        // Reap clients that hung up
+        for (auto it = connections_.begin(); it != connections_.end();) {
+            if (!(*it)->open) {
+                (*it)->reader.join();
+                it = connections_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        connection->reader = std::thread(&FaceServer::readLoop, this, connection);
+        connections_.push_back(std::move(connection));
+    }
+}
+
+void FaceServer::readLoop(std::shared_ptr<Connection> connection) {
+    while (running_) {
+        Request request;
+        if (!protocol::readFully(connection->fd, &request.header, sizeof(request.header))) {
+            break;
+        }
+
+        const auto& header = request.header;
+        if (header.magic != protocol::kRequestMagic || header.payload_size > protocol::kMaxPayloadSize) {
+            reply(*connection, header.request_id, protocol::Status::BadRequest,
+                  protocol::ResultEncoding::Binary, {});
+            break;
+        }
+
+        request.payload.resize(header.payload_size);
+        if (!protocol::readFully(connection->fd, request.payload.data(), request.payload.size())) {
+            break;
+        }
+
+        request.connection = connection;
+        request.has_deadline = header.deadline_ms > 0;
+        request.deadline = std::chrono::steady_clock::now() +
+                           std::chrono::milliseconds(header.deadline_ms);
+
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            if (queue_.size() < config_.queue_capacity) {
+                queue_.push_back(std::move(request));
+                queued = true;
+            }
+        }
+
+        if (queued) {
+            queue_ready_.notify_one();
+        } else {
+            // Backpressure: refuse now rather than queue work that will be late
+            reply(*connection, header.request_id, protocol::Status::Busy,
+                  static_cast<protocol::ResultEncoding>(header.result_encoding), {});
+        }
+    }
+    connection->open = false;
+}
+
+void FaceServer::dispatchLoop() {
+    std::vector<Request> batch;
+    std::vector<Request*> live;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_ready_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+            if (!running_) {
+                return;
+            }
+
+            // Give other clients a short window to join this batch
+            const auto window_end = std::chrono::steady_clock::now() + config_.batch_window;
+            while (running_ && queue_.size() < config_.max_batch) {
+                if (queue_ready_.wait_until(lock, window_end) == std::cv_status::timeout) {
+                    break;
+                }
+            }
+
+            const size_t count = std::min(config_.max_batch, queue_.size());
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        live.clear();
+        for (auto& request : batch) {
+            if (request.has_deadline && now > request.deadline) {
+                reply(*request.connection, request.header.request_id,
+                      protocol::Status::DeadlineExceeded,
+                      static_cast<protocol::ResultEncoding>(request.header.result_encoding), {});
+            } else {
+                live.push_back(&request);
+            }
+        }
+
+        auto run = [this, &live](size_t i) {
+            auto detector = acquireDetector();
+            process(*live[i], *detector);
+            releaseDetector(std::move(detector));
+        };
+        if (pool_) {
+            pool_->parallelFor(live.size(), run);
+        } else {
+            for (size_t i = 0; i < live.size(); ++i) {
+                run(i);
+            }
+        }
+        batch.clear();
+    }
+}
+
+void FaceServer::process(Request& request, FaceDetector& detector) {
+    const auto& header = request.header;
+    const auto encoding = static_cast<protocol::ResultEncoding>(header.result_encoding);
+    const auto frame_encoding = static_cast<protocol::FrameEncoding>(header.frame_encoding);
+
+    cv::Mat frame;
+    if (frame_encoding == protocol::FrameEncoding::Encoded) {
+        // Detection only needs luma, so skip the colour decode
+        frame = cv::imdecode(cv::Mat(1, static_cast<int>(request.payload.size()), CV_8UC1,
+                                     request.payload.data()),
+                             cv::IMREAD_GRAYSCALE);
+    } else {
+        const size_t bpp = bytesPerPixel(frame_encoding);
+        const size_t expected = static_cast<size_t>(header.width) * header.height * bpp;
+        if (bpp != 0 && header.width > 0 && header.height > 0 &&
+            expected == request.payload.size()) {
+            frame = cv::Mat(static_cast<int>(header.height), static_cast<int>(header.width),
+                            matType(frame_encoding), request.payload.data());
+        }
+    }
+
+    if (frame.empty()) {
+        reply(*request.connection, header.request_id, protocol::Status::BadRequest, encoding, {});
+        return;
+    }
+
+    const auto result = detector.detectFace(frame);
+
+    std::vector<uint8_t> payload;
+    if (encoding == protocol::ResultEncoding::Json) {
+        protocol::encodeResultJson(result, payload);
+    } else {
+        protocol::encodeResultBinary(result, payload);
+    }
+    reply(*request.connection, header.request_id, protocol::Status::Ok, encoding, payload);
+}
+
+void FaceServer::reply(Connection& connection, uint32_t requestId, protocol::Status status,
+                       protocol::ResultEncoding encoding, const std::vector<uint8_t>& payload) {
+    protocol::ResponseHeader header;
+    header.request_id = requestId;
+    header.status = static_cast<uint16_t>(status);
+    header.result_encoding = static_cast<uint16_t>(encoding);
+    header.payload_size = static_cast<uint32_t>(payload.size());
+
+    std::lock_guard<std::mutex> lock(connection.write_mutex);
+    if (!protocol::writeFully(connection.fd, &header, sizeof(header)) ||
+        !protocol::writeFully(connection.fd, payload.data(), payload.size())) {
+        connection.open = false;
+    }
+}
+
+std::unique_ptr<FaceDetector> FaceServer::acquireDetector() {
+    std::lock_guard<std::mutex> lock(detectors_mutex_);
+    // parallelFor never runs more items at once than there are detectors
+    auto detector = std::move(detectors_.back());
+    detectors_.pop_back();
+    return detector;
+}
+
+void FaceServer::releaseDetector(std::unique_ptr<FaceDetector> detector) {
+    std::lock_guard<std::mutex> lock(detectors_mutex_);
+    detectors_.push_back(std::move(detector));
+}
+
+} // namespace core
+} // namespace capvision
+
+#endif
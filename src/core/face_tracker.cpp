@@ -0,0 +1,259 @@
+#include "../../include/core/face_tracker.hpp"
+#include "../../include/core/instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+double overlap(const dlib::rectangle& a, const dlib::rectangle& b) {
+    const double shared = static_cast<double>(a.intersect(b).area());
+    const double combined = static_cast<double>(a.area() + b.area()) - shared;
+    return combined > 0.0 ? shared / combined : 0.0;
+}
+
+cv::Point2d centroid(const LandmarkArray& landmarks) {
+    cv::Point2d sum;
+    for (const cv::Point2f& p : landmarks) {
+        sum += cv::Point2d(p);
+    }
+    return landmarks.empty() ? sum : sum / static_cast<double>(landmarks.size());
+}
+
+double meanDistance(const LandmarkArray& a, const LandmarkArray& b) {
+    const size_t count = std::min(a.size(), b.size());
+    if (count == 0) {
+        return HUGE_VAL;
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += cv::norm(a[i] - b[i]);
+    }
+    return sum / count;
+}
+
+} // namespace
+
+FaceTracker::FaceTracker() : FaceTracker(Config{}) {
+}
+
+FaceTracker::FaceTracker(const Config& config) : config_(config) {
+}
+
+bool FaceTracker::initialize(std::shared_ptr<const FaceModels> models) {
+    if (!models) {
+        return false;
+    }
+    models_ = std::move(models);
+    scanner_ = std::make_unique<ParallelFaceScanner>(models_->face_detector, pool_);
+    workspace_ = CascadeShapePredictor::Workspace{};
+    reset();
+    return true;
+}
+
+void FaceTracker::setDetectionPool(std::shared_ptr<ThreadPool> pool) {
+    pool_ = std::move(pool);
+    if (models_) {
+        scanner_ = std::make_unique<ParallelFaceScanner>(models_->face_detector, pool_);
+    }
+}
+
+void FaceTracker::reset() {
+    tracks_.clear();
+    results_.clear();
+    frames_since_scan_ = 0;
+}
+
+dlib::rectangle FaceTracker::box(const Track& track) const {
+    // The scanned box, moved as far as the landmarks have since
+    const cv::Point2d shift = track.centroid - track.scanned_centroid;
+    return dlib::translate_rect(track.scanned_box, dlib::point(cvRound(shift.x), cvRound(shift.y)));
+}
+
+void FaceTracker::fit(Track& track, const cv::Size& frameSize, bool warm) {
+    const CascadeShapePredictor& predictor = models_->landmarks;
+    const dlib::rectangle roi = box(track);
+    if (warm && track.shape.num_parts() > 0) {
+        const unsigned long start_level = config_.refresh_start_level > 0
+            ? config_.refresh_start_level : predictor.numLevels() / 2;
+        track.shape = predictor.refine(pyramid_.level(0), roi, track.shape, start_level, workspace_);
+    } else {
+        track.shape = predictor(pyramid_.level(0), roi, workspace_);
+    }
+
+    track.face.landmarks.clear();
+    for (unsigned long i = 0; i < track.shape.num_parts(); ++i) {
+        const dlib::point& point = track.shape.part(i);
+        track.face.landmarks.emplace_back(static_cast<float>(point.x()), static_cast<float>(point.y()));
+    }
+
+    const cv::Point2d fitted = centroid(track.face.landmarks);
+    if (track.needs_fit) {
+        // A new track's box is anchored where its landmarks are now
+        track.scanned_centroid = fitted;
+        track.velocity = cv::Point2d();
+    } else if (frame_ > track.fitted_frame) {
+        track.velocity = (fitted - track.fitted_centroid) / static_cast<double>(frame_ - track.fitted_frame);
+    }
+    track.centroid = fitted;
+    track.fitted_centroid = fitted;
+    track.fitted_frame = frame_;
+    track.needs_fit = false;
+
+    const dlib::rectangle face = box(track);
+    track.face.face_rect = cv::Rect(face.left(), face.top(), face.width(), face.height());
+    track.face.success = head_pose_.estimate(track.face.landmarks, frameSize,
+                                             track.face.rotation_matrix, track.face.euler_angles);
+}
+
+void FaceTracker::scan(const cv::Size& frameSize) {
+    detections_ = (*scanner_)(pyramid_);
+
+    // Greedy matching, best overlap first
+    struct Pair {
+        double overlap;
+        size_t track;
+        size_t detection;
+    };
+    std::vector<Pair> pairs;
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+        const dlib::rectangle track_box = box(tracks_[t]);
+        for (size_t d = 0; d < detections_.size(); ++d) {
+            const double iou = overlap(track_box, detections_[d]);
+            if (iou >= config_.min_overlap) {
+                pairs.push_back(Pair{iou, t, d});
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const Pair& a, const Pair& b) { return a.overlap > b.overlap; });
+
+    std::vector<char> track_matched(tracks_.size(), 0);
+    std::vector<char> detection_matched(detections_.size(), 0);
+    for (const Pair& pair : pairs) {
+        if (track_matched[pair.track] || detection_matched[pair.detection]) {
+            continue;
+        }
+        Track& track = tracks_[pair.track];
+        track.scanned_box = detections_[pair.detection];
+        track.scanned_centroid = track.centroid;
+        track.missed_scans = 0;
+        track_matched[pair.track] = 1;
+        detection_matched[pair.detection] = 1;
+    }
+
+    // Boxes no track overlaps: the same face moved far, or a new one
+    for (size_t d = 0; d < detections_.size(); ++d) {
+        if (detection_matched[d]) {
+            continue;
+        }
+        Track candidate;
+        candidate.scanned_box = detections_[d];
+        fit(candidate, frameSize, false);
+
+        size_t best = tracks_.size();
+        double best_distance = config_.max_landmark_distance * detections_[d].width();
+        for (size_t t = 0; t < tracks_.size(); ++t) {
+            if (track_matched[t]) {
+                continue;
+            }
+            const double distance = meanDistance(candidate.face.landmarks, tracks_[t].face.landmarks);
+            if (distance <= best_distance) {
+                best = t;
+                best_distance = distance;
+            }
+        }
+
+        if (best < tracks_.size()) {
+            Track& track = tracks_[best];
+            if (frame_ > track.fitted_frame) {
+                track.velocity = (candidate.centroid - track.fitted_centroid) /
+                                 static_cast<double>(frame_ - track.fitted_frame);
+            }
+            candidate.id = track.id;
+            candidate.velocity = track.velocity;
+            track = candidate;
+            track_matched[best] = 1;
+        } else if (tracks_.size() < config_.max_tracks) {
+            candidate.id = next_id_++;
+            tracks_.push_back(candidate);
+            track_matched.push_back(1);
+        }
+    }
+
+    // Tracks no scan found for too long are gone
+    size_t kept = 0;
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+        if (!track_matched[t] && ++tracks_[t].missed_scans > config_.max_missed_scans) {
+            continue;
+        }
+        if (kept != t) {
+            tracks_[kept] = tracks_[t];
+        }
+        ++kept;
+    }
+    tracks_.resize(kept);
+}
+
+const std::vector<FaceDetector::FaceDetectionResult>& FaceTracker::update(const cv::Mat& frame) {
+    results_.clear();
+    scanned_ = false;
+    if (!scanner_ || frame.empty()) {
+        return results_;
+    }
+    ++frame_;
+
+    // Everyone moves on at their last measured speed; fits below overwrite
+    for (Track& track : tracks_) {
+        const cv::Point2f step(static_cast<float>(track.velocity.x), static_cast<float>(track.velocity.y));
+        for (cv::Point2f& point : track.face.landmarks) {
+            point += step;
+        }
+        track.centroid += track.velocity;
+        const dlib::rectangle face = box(track);
+        track.face.face_rect = cv::Rect(face.left(), face.top(), face.width(), face.height());
+    }
+
+    // Only the scan needs the upper pyramid levels
+    scanned_ = tracks_.empty() || ++frames_since_scan_ >= config_.scan_interval;
+    pyramid_.build(frame, scanned_ ? scanner_->countPyramidLevels(dlib::rectangle(frame.cols, frame.rows)) : 1);
+    int fitted = 0;
+    if (scanned_) {
+        frames_since_scan_ = 0;
+        scan(frame.size());
+        for (const Track& track : tracks_) {
+            fitted += track.fitted_frame == frame_ ? 1 : 0;
+        }
+    }
+
+    // Round robin: the tracks that have waited longest are refitted
+    for (int r = 0; r < config_.refreshes_per_frame; ++r) {
+        Track* oldest = nullptr;
+        for (Track& track : tracks_) {
+            if (track.fitted_frame < frame_ && (!oldest || track.fitted_frame < oldest->fitted_frame)) {
+                oldest = &track;
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+        fit(*oldest, frame.size(), true);
+        ++fitted;
+    }
+
+    for (const Track& track : tracks_) {
+        if (track.face.success) {
+            results_.push_back(track.face);
+            results_.back().track_id = track.id;
+        }
+    }
+
+    auto& stats = Instrumentation::global();
+    stats.set("tracker.tracks", static_cast<double>(tracks_.size()));
+    stats.set("tracker.refreshed", fitted);
+    return results_;
+}
+
+} // namespace core
+} // namespace capvision
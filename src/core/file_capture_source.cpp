@@ -0,0 +1,103 @@
+#include "../../include/core/file_capture_source.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+namespace capvision {
+namespace core {
+
+FileCaptureSource::FileCaptureSource(const std::string& path)
+    : FileCaptureSource(path, Options{}) {
+}
+
+FileCaptureSource::FileCaptureSource(const std::string& path, const Options& options)
+    : path_(path)
+    , options_(options) {
+}
+
+FileCaptureSource::~FileCaptureSource() = default;
+
+bool FileCaptureSource::open() {
+    close();
+
+    double fps = options_.fps;
+    std::error_code error;
+    if (std::filesystem::is_directory(path_, error)) {
+        for (const auto& entry : std::filesystem::directory_iterator(path_, error)) {
+            if (entry.is_regular_file() && cv::haveImageReader(entry.path().string())) {
+                image_files_.push_back(entry.path().string());
+            }
+        }
+        std::sort(image_files_.begin(), image_files_.end());
+        opened_ = !image_files_.empty();
+    } else {
+        // VideoCapture also handles printf-style image sequences
+        opened_ = video_.open(path_);
+        const double file_fps = opened_ ? video_.get(cv::CAP_PROP_FPS) : 0.0;
+        if (file_fps > 0.0) {
+            fps = file_fps;
+        }
+    }
+
+    frame_interval_us_ = 1e6 / fps;
+    start_us_ = steadyNowMicros();
+    return opened_;
+}
+
+void FileCaptureSource::close() {
+    video_.release();
+    image_files_.clear();
+    next_image_ = 0;
+    sequence_ = 0;
+    opened_ = false;
+}
+
+bool FileCaptureSource::readNext(cv::Mat& image) {
+    if (image_files_.empty()) {
+        if (video_.read(image)) {
+            return true;
+        }
+        if (!options_.loop) {
+            return false;
+        }
+        video_.set(cv::CAP_PROP_POS_FRAMES, 0);
+        return video_.read(image);
+    }
+
+    if (next_image_ == image_files_.size()) {
+        if (!options_.loop) {
+            return false;
+        }
+        next_image_ = 0;
+    }
+    image = cv::imread(image_files_[next_image_++], cv::IMREAD_COLOR);
+    return !image.empty();
+}
+
+bool FileCaptureSource::read(CapturedFrame& frame) {
+    if (!opened_) {
+        return false;
+    }
+    if (!readNext(frame.image)) {
+        // End of the clip: report the source as closed so readers stop polling
+        opened_ = false;
+        return false;
+    }
+
+    frame.format = PixelFormat::BGR;
+    frame.sequence = sequence_;
+    frame.timestamp_us = start_us_ + static_cast<int64_t>(sequence_ * frame_interval_us_);
+    ++sequence_;
+
+    if (options_.paced) {
+        const int64_t wait_us = frame.timestamp_us - steadyNowMicros();
+        if (wait_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(wait_us));
+        }
+    }
+    return true;
+}
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,155 @@
+#include "../../include/core/flat_shape_model.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace capvision {
+namespace core {
+
+bool FlatShapeModel::build(const dlib::matrix<float, 0, 1>& initialShape,
+                           const std::vector<std::vector<dlib::impl::regression_tree>>& forests,
+                           const std::vector<std::vector<unsigned long>>& anchorIdx,
+                           const std::vector<std::vector<dlib::vector<float, 2>>>& deltas) {
+    levels_.clear();
+    if (forests.empty() || forests[0].empty()) {
+        return false;
+    }
+
+    initial_shape_ = initialShape;
+    shape_size_ = static_cast<unsigned long>(initialShape.size());
+    splits_per_tree_ = static_cast<unsigned long>(forests[0][0].splits.size());
+    leaves_per_tree_ = static_cast<unsigned long>(forests[0][0].leaf_values.size());
+    const size_t trees_per_level = forests[0].size();
+    if (splits_per_tree_ == 0 || leaves_per_tree_ != splits_per_tree_ + 1) {
+        return false;
+    }
+
+    std::vector<Level> levels(forests.size());
+    for (size_t l = 0; l < forests.size(); ++l) {
+        Level& level = levels[l];
+        const size_t pixel_count = deltas[l].size();
+        if (pixel_count > std::numeric_limits<uint16_t>::max() || forests[l].size() != trees_per_level) {
+            return false;
+        }
+
+        level.anchor.resize(pixel_count);
+        level.delta_x.resize(pixel_count);
+        level.delta_y.resize(pixel_count);
+        for (size_t p = 0; p < pixel_count; ++p) {
+            level.anchor[p] = static_cast<uint16_t>(anchorIdx[l][p]);
+            level.delta_x[p] = deltas[l][p].x();
+            level.delta_y[p] = deltas[l][p].y();
+        }
+
+        // One scale per level, from its largest leaf value
+        float max_leaf = 0.0f;
+        for (const auto& tree : forests[l]) {
+            if (tree.splits.size() != splits_per_tree_ || tree.leaf_values.size() != leaves_per_tree_) {
+                return false;
+            }
+            for (const auto& leaf : tree.leaf_values) {
+                if (static_cast<unsigned long>(leaf.size()) != shape_size_) {
+                    return false;
+                }
+                max_leaf = std::max(max_leaf, dlib::max(dlib::abs(leaf)));
+            }
+        }
+        level.leaf_scale = max_leaf > 0.0f ? max_leaf / 32767.0f : 1.0f;
+
+        level.split_idx1.reserve(trees_per_level * splits_per_tree_);
+        level.split_idx2.reserve(trees_per_level * splits_per_tree_);
+        level.split_thresh.reserve(trees_per_level * splits_per_tree_);
+        level.leaves.reserve(trees_per_level * leaves_per_tree_ * shape_size_);
+        for (const auto& tree : forests[l]) {
+            for (const auto& split : tree.splits) {
+                level.split_idx1.push_back(static_cast<uint16_t>(split.idx1));
+                level.split_idx2.push_back(static_cast<uint16_t>(split.idx2));
+                level.split_thresh.push_back(split.thresh);
+            }
+            for (const auto& leaf : tree.leaf_values) {
+                for (long k = 0; k < leaf.size(); ++k) {
+                    level.leaves.push_back(static_cast<int16_t>(std::lround(leaf(k) / level.leaf_scale)));
+                }
+            }
+        }
+    }
+
+    levels_ = std::move(levels);
+    trees_per_level_ = static_cast<unsigned long>(trees_per_level);
+    return true;
+}
+
+size_t FlatShapeModel::memoryBytes() const {
+    size_t bytes = initial_shape_.size() * sizeof(float);
+    for (const auto& level : levels_) {
+        bytes += level.anchor.capacity() * sizeof(uint16_t) +
+                 (level.delta_x.capacity() + level.delta_y.capacity()) * sizeof(float) +
+                 (level.split_idx1.capacity() + level.split_idx2.capacity()) * sizeof(uint16_t) +
+                 level.split_thresh.capacity() * sizeof(float) +
+                 level.leaves.capacity() * sizeof(int16_t);
+    }
+    return bytes;
+}
+
+void FlatShapeModel::evaluate(const unsigned char* pixels, long rows, long cols, long stride,
+                              const dlib::rectangle& rect, unsigned long firstLevel, unsigned long endLevel,
+                              unsigned long trees, dlib::matrix<float, 0, 1>& shape,
+                              Scratch& scratch) const {
+    endLevel = std::min<unsigned long>(endLevel, static_cast<unsigned long>(levels_.size()));
+
+    // unnormalizing_tform(rect): the unit square onto the face box
+    const double left = static_cast<double>(rect.left());
+    const double top = static_cast<double>(rect.top());
+    const double scale_x = static_cast<double>(rect.right() - rect.left());
+    const double scale_y = static_cast<double>(rect.bottom() - rect.top());
+    scratch.accumulator.resize(shape_size_);
+
+    for (unsigned long l = firstLevel; l < endLevel; ++l) {
+        const Level& level = levels_[l];
+        const size_t pixel_count = level.anchor.size();
+        scratch.features.resize(pixel_count);
+
+        // Sample the feature pixels around the current shape estimate
+        const dlib::matrix<float, 2, 2> tform = dlib::matrix_cast<float>(
+            dlib::impl::find_tform_between_shapes(initial_shape_, shape).get_m());
+        const float m00 = tform(0, 0), m01 = tform(0, 1), m10 = tform(1, 0), m11 = tform(1, 1);
+        const float* current = &shape(0);
+        for (size_t p = 0; p < pixel_count; ++p) {
+            const float nx = m00 * level.delta_x[p] + m01 * level.delta_y[p] + current[2 * level.anchor[p]];
+            const float ny = m10 * level.delta_x[p] + m11 * level.delta_y[p] + current[2 * level.anchor[p] + 1];
+            const long x = static_cast<long>(std::floor(left + nx * scale_x + 0.5));
+            const long y = static_cast<long>(std::floor(top + ny * scale_y + 0.5));
+            const bool inside = x >= 0 && y >= 0 && x < cols && y < rows;
+            scratch.features[p] = inside ? pixels[y * stride + x] : 0.0f;
+        }
+
+        // Walk each tree branch-free and sum its leaf into the accumulator
+        const unsigned long tree_count = std::min(trees, trees_per_level_);
+        const float* features = scratch.features.data();
+        int32_t* accumulator = scratch.accumulator.data();
+        std::fill(scratch.accumulator.begin(), scratch.accumulator.end(), 0);
+        for (unsigned long t = 0; t < tree_count; ++t) {
+            const uint16_t* idx1 = &level.split_idx1[t * splits_per_tree_];
+            const uint16_t* idx2 = &level.split_idx2[t * splits_per_tree_];
+            const float* thresh = &level.split_thresh[t * splits_per_tree_];
+
+            unsigned long node = 0;
+            while (node < splits_per_tree_) {
+                const bool left_child = features[idx1[node]] - features[idx2[node]] > thresh[node];
+                node = 2 * node + (left_child ? 1 : 2);
+            }
+
+            const int16_t* leaf = &level.leaves[(t * leaves_per_tree_ + node - splits_per_tree_) * shape_size_];
+            for (unsigned long k = 0; k < shape_size_; ++k) {
+                accumulator[k] += leaf[k];
+            }
+        }
+
+        for (unsigned long k = 0; k < shape_size_; ++k) {
+            shape(k) += accumulator[k] * level.leaf_scale;
+        }
+    }
+}
+
+} // namespace core
+} // namespace capvision
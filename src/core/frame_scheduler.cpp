@@ -0,0 +1,91 @@
+#include "../../include/core/frame_scheduler.hpp"
+#include "../../include/core/instrumentation.hpp"
+#include <algorithm>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+double smooth(double average, double sample, double weight) {
+    return average + weight * (sample - average);
+}
+
+} // namespace
+
+FrameScheduler::Settings FrameScheduler::settingsFor(int level) {
+    // Cheapest knobs first: landmark levels cost little accuracy, skipped
+    // detections are covered by box tracking, a coarser scan only loses
+    // small faces, and the cap mesh is the most visible
+    static const Settings kLadder[kLevelCount] = {
+        {CascadeShapePredictor::kMaxQualityLevel, 1, 0, 0},
+        {3, 1, 0, 0},
+        {2, 2, 0, 0},
+        {2, 2, 1, 1},
+        {1, 3, 2, 1},
+        {0, 4, 3, 2},
+    };
+    return kLadder[std::max(0, std::min(level, kLevelCount - 1))];
+}
+
+FrameScheduler::FrameScheduler()
+    : FrameScheduler(Config{}) {
+}
+
+FrameScheduler::FrameScheduler(const Config& config)
+    : config_(config)
+    , settings_(settingsFor(0)) {
+    Instrumentation::global().set("scheduler.budget_ms", config_.budget_ms);
+    publish();
+}
+
+bool FrameScheduler::endFrame(const FrameCost& cost) {
+    if (!has_cost_) {
+        smoothed_ = cost;
+        has_cost_ = true;
+    } else {
+        const double w = config_.smoothing;
+        smoothed_.capture_ms = smooth(smoothed_.capture_ms, cost.capture_ms, w);
+        smoothed_.detection_ms = smooth(smoothed_.detection_ms, cost.detection_ms, w);
+        smoothed_.landmarks_ms = smooth(smoothed_.landmarks_ms, cost.landmarks_ms, w);
+        smoothed_.pose_ms = smooth(smoothed_.pose_ms, cost.pose_ms, w);
+        smoothed_.render_ms = smooth(smoothed_.render_ms, cost.render_ms, w);
+    }
+
+    // Step down on sustained overload, judged per frame so a spike run is
+    // caught quickly; step up only on sustained headroom in the average
+    over_budget_run_ = cost.total() > config_.budget_ms ? over_budget_run_ + 1 : 0;
+    headroom_run_ = smoothed_.total() < config_.recover_fraction * config_.budget_ms ? headroom_run_ + 1 : 0;
+
+    const int previous = level_;
+    if (over_budget_run_ >= config_.overload_frames && level_ < kLevelCount - 1) {
+        setLevel(level_ + 1);
+        Instrumentation::global().add("scheduler.steps_down");
+    } else if (headroom_run_ >= config_.recover_frames && level_ > 0) {
+        setLevel(level_ - 1);
+        Instrumentation::global().add("scheduler.steps_up");
+    }
+    publish();
+    return level_ != previous;
+}
+
+void FrameScheduler::setLevel(int level) {
+    level_ = level;
+    settings_ = settingsFor(level);
+    over_budget_run_ = 0;
+    headroom_run_ = 0;
+}
+
+void FrameScheduler::publish() const {
+    Instrumentation& stats = Instrumentation::global();
+    stats.set("scheduler.level", level_);
+    stats.set("scheduler.frame_ms", smoothed_.total());
+    stats.set("stage.capture_ms", smoothed_.capture_ms);
+    stats.set("stage.detection_ms", smoothed_.detection_ms);
+    stats.set("stage.landmarks_ms", smoothed_.landmarks_ms);
+    stats.set("stage.pose_ms", smoothed_.pose_ms);
+    stats.set("stage.render_ms", smoothed_.render_ms);
+}
+
+} // namespace core
+} // namespace capvision
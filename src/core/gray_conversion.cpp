@@ -0,0 +1,77 @@
+#include "../../include/core/gray_conversion.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+bool detectAvx2() {
+#if !defined(CAPVISION_HAVE_AVX2)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    // OSXSAVE and AVX, then the OS must save the YMM state
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+void bgrToGrayRowScalar(const unsigned char* bgr, unsigned char* gray, size_t width) {
+    for (size_t x = 0; x < width; ++x, bgr += 3) {
+        gray[x] = static_cast<unsigned char>((29 * bgr[0] + 150 * bgr[1] + 77 * bgr[2] + 128) >> 8);
+    }
+}
+
+void yuyvToGrayRowScalar(const unsigned char* yuyv, unsigned char* gray, size_t width) {
+    for (size_t x = 0; x < width; ++x) {
+        gray[x] = yuyv[2 * x];
+    }
+}
+
+bool avx2Available() {
+    static const bool available = detectAvx2();
+    return available;
+}
+
+void bgrToGrayRow(const unsigned char* bgr, unsigned char* gray, size_t width) {
+    if (avx2Available()) {
+        bgrToGrayRowAvx2(bgr, gray, width);
+    } else {
+        bgrToGrayRowScalar(bgr, gray, width);
+    }
+}
+
+void yuyvToGrayRow(const unsigned char* yuyv, unsigned char* gray, size_t width) {
+    if (avx2Available()) {
+        yuyvToGrayRowAvx2(yuyv, gray, width);
+    } else {
+        yuyvToGrayRowScalar(yuyv, gray, width);
+    }
+}
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,125 @@
+// Built with AVX2 code generation (see CMakeLists.txt); nothing here may run
+// before avx2Available() has been checked.
+#include "../../include/core/gray_conversion.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace capvision {
+namespace core {
+
+#if defined(__AVX2__)
+
+namespace {
+
+// Gathers one channel of 16 packed BGR pixels spread over three 16-byte
+// chunks; each 128-bit lane is handled independently by _mm256_shuffle_epi8.
+inline __m256i gatherChannel(__m256i a, __m256i b, __m256i c,
+                             __m256i mask_a, __m256i mask_b, __m256i mask_c) {
+    return _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(a, mask_a),
+                                           _mm256_shuffle_epi8(b, mask_b)),
+                           _mm256_shuffle_epi8(c, mask_c));
+}
+
+inline __m256i loadPair(const unsigned char* low, const unsigned char* high) {
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(low))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(high)), 1);
+}
+
+inline __m256i weightedSum(__m256i b, __m256i g, __m256i r,
+                           __m256i wb, __m256i wg, __m256i wr, __m256i round) {
+    // 255 * (29 + 150 + 77) + 128 fits in an unsigned 16-bit lane
+    __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(b, wb), _mm256_mullo_epi16(g, wg));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(r, wr));
+    return _mm256_srli_epi16(_mm256_add_epi16(sum, round), 8);
+}
+
+} // namespace
+
+void bgrToGrayRowAvx2(const unsigned char* bgr, unsigned char* gray, size_t width) {
+    const char z = -1;
+    const __m256i b_from_a = _mm256_setr_epi8(0, 3, 6, 9, 12, 15, z, z, z, z, z, z, z, z, z, z,
+                                              0, 3, 6, 9, 12, 15, z, z, z, z, z, z, z, z, z, z);
+    const __m256i b_from_b = _mm256_setr_epi8(z, z, z, z, z, z, 2, 5, 8, 11, 14, z, z, z, z, z,
+                                              z, z, z, z, z, z, 2, 5, 8, 11, 14, z, z, z, z, z);
+    const __m256i b_from_c = _mm256_setr_epi8(z, z, z, z, z, z, z, z, z, z, z, 1, 4, 7, 10, 13,
+                                              z, z, z, z, z, z, z, z, z, z, z, 1, 4, 7, 10, 13);
+    const __m256i g_from_a = _mm256_setr_epi8(1, 4, 7, 10, 13, z, z, z, z, z, z, z, z, z, z, z,
+                                              1, 4, 7, 10, 13, z, z, z, z, z, z, z, z, z, z, z);
+    const __m256i g_from_b = _mm256_setr_epi8(z, z, z, z, z, 0, 3, 6, 9, 12, 15, z, z, z, z, z,
+                                              z, z, z, z, z, 0, 3, 6, 9, 12, 15, z, z, z, z, z);
+    const __m256i g_from_c = _mm256_setr_epi8(z, z, z, z, z, z, z, z, z, z, z, 2, 5, 8, 11, 14,
+                                              z, z, z, z, z, z, z, z, z, z, z, 2, 5, 8, 11, 14);
+    const __m256i r_from_a = _mm256_setr_epi8(2, 5, 8, 11, 14, z, z, z, z, z, z, z, z, z, z, z,
+                                              2, 5, 8, 11, 14, z, z, z, z, z, z, z, z, z, z, z);
+    const __m256i r_from_b = _mm256_setr_epi8(z, z, z, z, z, 1, 4, 7, 10, 13, z, z, z, z, z, z,
+                                              z, z, z, z, z, 1, 4, 7, 10, 13, z, z, z, z, z, z);
+    const __m256i r_from_c = _mm256_setr_epi8(z, z, z, z, z, z, z, z, z, z, 0, 3, 6, 9, 12, 15,
+                                              z, z, z, z, z, z, z, z, z, z, 0, 3, 6, 9, 12, 15);
+
+    const __m256i wb = _mm256_set1_epi16(29);
+    const __m256i wg = _mm256_set1_epi16(150);
+    const __m256i wr = _mm256_set1_epi16(77);
+    const __m256i round = _mm256_set1_epi16(128);
+    const __m256i zero = _mm256_setzero_si256();
+
+    // 32 pixels per iteration: pixels 0-15 in the low lanes, 16-31 in the high lanes
+    size_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const unsigned char* p = bgr + 3 * x;
+        const __m256i a = loadPair(p, p + 48);
+        const __m256i b = loadPair(p + 16, p + 64);
+        const __m256i c = loadPair(p + 32, p + 80);
+
+        const __m256i blue = gatherChannel(a, b, c, b_from_a, b_from_b, b_from_c);
+        const __m256i green = gatherChannel(a, b, c, g_from_a, g_from_b, g_from_c);
+        const __m256i red = gatherChannel(a, b, c, r_from_a, r_from_b, r_from_c);
+
+        // Unpack and pack are both per lane, so pixel order survives the round trip
+        const __m256i low = weightedSum(_mm256_unpacklo_epi8(blue, zero),
+                                        _mm256_unpacklo_epi8(green, zero),
+                                        _mm256_unpacklo_epi8(red, zero), wb, wg, wr, round);
+        const __m256i high = weightedSum(_mm256_unpackhi_epi8(blue, zero),
+                                         _mm256_unpackhi_epi8(green, zero),
+                                         _mm256_unpackhi_epi8(red, zero), wb, wg, wr, round);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(gray + x), _mm256_packus_epi16(low, high));
+    }
+
+    bgrToGrayRowScalar(bgr + 3 * x, gray + x, width - x);
+}
+
+void yuyvToGrayRowAvx2(const unsigned char* yuyv, unsigned char* gray, size_t width) {
+    const __m256i luma_mask = _mm256_set1_epi16(0x00FF);
+
+    size_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const unsigned char* p = yuyv + 2 * x;
+        const __m256i a = _mm256_and_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), luma_mask);
+        const __m256i b = _mm256_and_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), luma_mask);
+
+        // packus interleaves the 64-bit halves of a and b; restore pixel order
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(gray + x), packed);
+    }
+
+    yuyvToGrayRowScalar(yuyv + 2 * x, gray + x, width - x);
+}
+
+#else
+
+void bgrToGrayRowAvx2(const unsigned char* bgr, unsigned char* gray, size_t width) {
+    bgrToGrayRowScalar(bgr, gray, width);
+}
+
+void yuyvToGrayRowAvx2(const unsigned char* yuyv, unsigned char* gray, size_t width) {
+    yuyvToGrayRowScalar(yuyv, gray, width);
+}
+
+#endif
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,54 @@
+#include "../../include/core/gray_pyramid.hpp"
+#include "../../include/core/gray_conversion.hpp"
+#include <algorithm>
+
+namespace capvision {
+namespace core {
+
+void GrayPyramid::build(const cv::Mat& frame, unsigned long num_levels) {
+    CV_Assert((frame.type() == CV_8UC3 || frame.type() == CV_8UC2 || frame.type() == CV_8UC1) &&
+              num_levels >= 1);
+
+    if (levels_.size() < num_levels) {
+        levels_.resize(num_levels);
+    }
+    num_levels_ = num_levels;
+
+    // Level 0: one pass from the camera rows into the luma plane
+    level_type& base = levels_[0];
+    base.set_size(frame.rows, frame.cols);
+    for (int y = 0; y < frame.rows; ++y) {
+        const unsigned char* src = frame.ptr<unsigned char>(y);
+        unsigned char* dst = &base[y][0];
+        switch (frame.type()) {
+        case CV_8UC3:
+            bgrToGrayRow(src, dst, frame.cols);
+            break;
+        case CV_8UC2:
+            yuyvToGrayRow(src, dst, frame.cols);
+            break;
+        default:
+            std::copy(src, src + frame.cols, dst);
+            break;
+        }
+    }
+
+    dlib::pyramid_down<6> pyr;
+    for (unsigned long l = 1; l < num_levels; ++l) {
+        pyr(levels_[l - 1], levels_[l]);
+    }
+}
+
+cv::Mat GrayPyramid::levelMat(size_t index) const {
+    const level_type& level = levels_[index];
+    if (level.size() == 0) {
+        return cv::Mat();
+    }
+
+    return cv::Mat(static_cast<int>(level.nr()), static_cast<int>(level.nc()), CV_8UC1,
+                   const_cast<unsigned char*>(&level[0][0]),
+                   static_cast<size_t>(level.width_step()));
+}
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,59 @@
+#include "../../include/core/head_pose.hpp"
+
+namespace capvision {
+namespace core {
+
+HeadPoseEstimator::HeadPoseEstimator() {
+    // Initialize 3D model points for pose estimation
+    model_points_3d_ = {
+        cv::Point3d(0.0, 0.0, 0.0),          // Nose tip
+        cv::Point3d(0.0, -330.0, -65.0),     // Chin
+        cv::Point3d(-225.0, 170.0, -135.0),  // Left eye corner
+        cv::Point3d(225.0, 170.0, -135.0),   // Right eye corner
+        cv::Point3d(-150.0, -150.0, -125.0), // Left mouth corner
+        cv::Point3d(150.0, -150.0, -125.0)   // Right mouth corner
+    };
+}
+
+bool HeadPoseEstimator::estimate(const LandmarkArray& landmarks, const cv::Size& frameSize,
+                                 cv::Matx33d& rotation, cv::Vec3d& eulerDegrees) {
+    if (landmarks.size() <= 54) {
+        return false;
+    }
+
+    // Initialize camera matrix if needed; server detectors see frames of any size
+    if (camera_matrix_(0, 0) != frameSize.width || camera_matrix_(1, 2) != frameSize.height / 2) {
+        float focal_length = frameSize.width;
+        cv::Point2d center(frameSize.width/2, frameSize.height/2);
+        camera_matrix_ = cv::Matx33d(
+            focal_length, 0, center.x,
+            0, focal_length, center.y,
+            0, 0, 1);
+    }
+
+    // Get specific facial landmarks for pose estimation
+    const std::array<cv::Point2d, 6> image_points = {
+        landmarks[30],    // Nose tip
+        landmarks[8],     // Chin
+        landmarks[36],    // Left eye corner
+        landmarks[45],    // Right eye corner
+        landmarks[48],    // Left mouth corner
+        landmarks[54]     // Right mouth corner
+    };
+
+    // Solve for pose; fixed-size outputs keep this off the heap
+    cv::Vec3d rvec, tvec;
+    cv::solvePnP(model_points_3d_, image_points, camera_matrix_, dist_coeffs_,
+                 rvec, tvec, false, cv::SOLVEPNP_ITERATIVE);
+
+    // Convert rotation vector to rotation matrix
+    cv::Rodrigues(rvec, rotation);
+
+    // Store rotation vector directly (in degrees)
+    // This gives us rotation around X, Y, Z axes directly
+    eulerDegrees = rvec * (180.0 / CV_PI);
+    return true;
+}
+
+} // namespace core
+} // namespace capvision
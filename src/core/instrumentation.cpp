@@ -0,0 +1,55 @@
+#include "../../include/core/instrumentation.hpp"
+#include <sstream>
+
+namespace capvision {
+namespace core {
+
+Instrumentation& Instrumentation::global() {
+    static Instrumentation instance;
+    return instance;
+}
+
+void Instrumentation::set(std::string_view name, double value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = values_.find(name);
+    if (it == values_.end()) {
+        values_.emplace(std::string(name), value);
+    } else {
+        it->second = value;
+    }
+}
+
+void Instrumentation::add(std::string_view name, double delta) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = values_.find(name);
+    if (it == values_.end()) {
+        values_.emplace(std::string(name), delta);
+    } else {
+        it->second += delta;
+    }
+}
+
+double Instrumentation::value(std::string_view name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = values_.find(name);
+    return it == values_.end() ? 0.0 : it->second;
+}
+
+std::vector<std::pair<std::string, double>> Instrumentation::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {values_.begin(), values_.end()};
+}
+
+std::string Instrumentation::format() const {
+    std::ostringstream out;
+    for (const auto& [name, value] : snapshot()) {
+        if (out.tellp() > 0) {
+            out << ' ';
+        }
+        out << name << '=' << value;
+    }
+    return out.str();
+}
+
+} // namespace core
+} // namespace capvision
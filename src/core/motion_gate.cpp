@@ -0,0 +1,113 @@
+#include "../../include/core/motion_gate.hpp"
+#include "../../include/core/instrumentation.hpp"
+
+namespace capvision {
+namespace core {
+
+MotionGate::MotionGate() : MotionGate(Config{}) {
+}
+
+MotionGate::MotionGate(const Config& config) : config_(config) {
+}
+
+void MotionGate::reset() {
+    has_reference_ = false;
+    has_face_ = false;
+    reused_frames_ = 0;
+    idle_ = false;
+    changed_ = 0.0;
+}
+
+void MotionGate::makeThumbnail(const cv::Mat& frame) {
+    // INTER_AREA averages whole blocks, which also filters sensor noise
+    switch (frame.channels()) {
+    case 1:
+        cv::resize(frame, thumbnail_, config_.thumbnail, 0, 0, cv::INTER_AREA);
+        break;
+    case 2:
+        // YUYV: channel 0 is luma at every pixel
+        cv::resize(frame, scaled_, config_.thumbnail, 0, 0, cv::INTER_AREA);
+        cv::extractChannel(scaled_, thumbnail_, 0);
+        break;
+    case 4:
+        cv::resize(frame, scaled_, config_.thumbnail, 0, 0, cv::INTER_AREA);
+        cv::cvtColor(scaled_, thumbnail_, cv::COLOR_BGRA2GRAY);
+        break;
+    default:
+        cv::resize(frame, scaled_, config_.thumbnail, 0, 0, cv::INTER_AREA);
+        cv::cvtColor(scaled_, thumbnail_, cv::COLOR_BGR2GRAY);
+        break;
+    }
+}
+
+cv::Rect MotionGate::watchedRegion() const {
+    const cv::Rect whole(cv::Point(0, 0), config_.thumbnail);
+    if (!has_face_ || frame_size_.width <= 0 || frame_size_.height <= 0) {
+        return whole;
+    }
+
+    const double sx = static_cast<double>(config_.thumbnail.width) / frame_size_.width;
+    const double sy = static_cast<double>(config_.thumbnail.height) / frame_size_.height;
+    const double margin = config_.face_margin * face_rect_.width;
+    const cv::Rect region(cvFloor((face_rect_.x - margin) * sx), cvFloor((face_rect_.y - margin) * sy),
+                          cvCeil((face_rect_.width + 2.0 * margin) * sx),
+                          cvCeil((face_rect_.height + 2.0 * margin) * sy));
+    const cv::Rect clipped = region & whole;
+    return clipped.area() > 0 ? clipped : whole;
+}
+
+bool MotionGate::check(const cv::Mat& frame, int64_t timestampUs) {
+    if (frame.empty()) {
+        return true;
+    }
+    makeThumbnail(frame);
+    if (!has_reference_ || frame.size() != frame_size_) {
+        frame_size_ = frame.size();
+        return true;
+    }
+
+    const cv::Rect region = watchedRegion();
+    cv::absdiff(thumbnail_(region), reference_(region), diff_);
+    cv::threshold(diff_, diff_, config_.pixel_threshold, 255, cv::THRESH_BINARY);
+    changed_ = static_cast<double>(cv::countNonZero(diff_)) / region.area();
+
+    idle_ = !has_face_ && (timestampUs - last_face_us_) >= config_.idle_after_ms * 1000.0;
+    const bool refresh = idle_
+        ? (timestampUs - last_detect_us_) >= config_.idle_scan_ms * 1000.0
+        : reused_frames_ >= config_.max_reuse_frames;
+
+    auto& stats = Instrumentation::global();
+    stats.set("gate.changed", changed_);
+    stats.set("gate.idle", idle_ ? 1.0 : 0.0);
+    if (changed_ > config_.changed_fraction || refresh) {
+        return true;
+    }
+    ++reused_frames_;
+    stats.add("gate.reused");
+    return false;
+}
+
+void MotionGate::update(const FaceDetector::FaceDetectionResult& result, int64_t timestampUs) {
+    if (thumbnail_.empty()) {
+        return;
+    }
+    // The reference is the detected frame, not the previous one, so slow
+    // drift adds up until it crosses the threshold
+    thumbnail_.copyTo(reference_);
+    if (!has_reference_) {
+        last_face_us_ = timestampUs;
+    }
+    has_reference_ = true;
+    reused_frames_ = 0;
+    last_detect_us_ = timestampUs;
+
+    has_face_ = result.success;
+    if (result.success) {
+        face_rect_ = result.face_rect;
+        last_face_us_ = timestampUs;
+        idle_ = false;
+    }
+}
+
+} // namespace core
+} // namespace capvision
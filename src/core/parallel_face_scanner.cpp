@@ -0,0 +1,162 @@
+#include "../../include/core/parallel_face_scanner.hpp"
+#include <limits>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+long roundUpTo(long value, long multiple) {
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+
+} // namespace
+
+ParallelFaceScanner::ParallelFaceScanner(const detector_type& detector,
+                                         std::shared_ptr<ThreadPool> pool)
+    : ParallelFaceScanner(detector, std::move(pool), Config{}) {
+}
+
+ParallelFaceScanner::ParallelFaceScanner(const detector_type& detector,
+                                         std::shared_ptr<ThreadPool> pool,
+                                         const Config& config)
+    : pool_(std::move(pool))
+    , config_(config)
+    , overlap_tester_(detector.get_overlap_tester()) {
+    const scanner_type& scanner = detector.get_scanner();
+    scanner_config_.copy_configuration(scanner);
+    max_pyramid_levels_ = scanner.get_max_pyramid_levels();
+    scanner_config_.set_max_pyramid_levels(1);
+
+    // Same per-filter thresholds object_detector applies: the last weight is the bias
+    for (unsigned long i = 0; i < detector.num_detectors(); ++i) {
+        const auto& w = detector.get_w(i);
+        filterbanks_.push_back(scanner.build_fhog_filterbank(w));
+        thresholds_.push_back(w(scanner.get_num_dimensions()));
+    }
+
+    // A window centred in a tile's core must lie inside the tile, plus the
+    // cells that feed its HOG interpolation and block normalisation.
+    const long cell_size = static_cast<long>(scanner.get_cell_size());
+    const long window = static_cast<long>(std::max(scanner.get_detection_window_width(),
+                                                   scanner.get_detection_window_height()));
+    halo_ = roundUpTo(window / 2 + 4 * cell_size, cell_size);
+    config_.tile_size = roundUpTo(std::max(config_.tile_size, cell_size), cell_size);
+}
+
+unsigned long ParallelFaceScanner::countPyramidLevels(const dlib::rectangle& image_rect) const {
+    // Mirrors the level count computed by scan_fhog_pyramid::load()
+    pyramid_type pyr;
+    dlib::rectangle rect = image_rect;
+    unsigned long levels = 0;
+    do {
+        rect = pyr.rect_down(rect);
+        ++levels;
+    } while (rect.width() >= scanner_config_.get_min_pyramid_layer_width() &&
+             rect.height() >= scanner_config_.get_min_pyramid_layer_height() &&
+             levels < max_pyramid_levels_);
+    return levels;
+}
+
+void ParallelFaceScanner::planLevel(unsigned long level, const dlib::rectangle& level_rect,
+                                    std::vector<ScanJob>& jobs) const {
+    const long width = static_cast<long>(level_rect.width());
+    const long height = static_cast<long>(level_rect.height());
+
+    if (width <= config_.min_tiled_dimension && height <= config_.min_tiled_dimension) {
+        ScanJob job;
+        job.level = level;
+        job.tile = level_rect;
+        jobs.push_back(job);
+        return;
+    }
+
+    // Tile origins stay on multiples of the cell size so the HOG grid of every
+    // tile lines up with the grid of the whole level.
+    const long unbounded = std::numeric_limits<int>::max();
+    for (long top = 0; top < height; top += config_.tile_size) {
+        for (long left = 0; left < width; left += config_.tile_size) {
+            const long right = std::min(left + config_.tile_size, width) - 1;
+            const long bottom = std::min(top + config_.tile_size, height) - 1;
+
+            ScanJob job;
+            job.level = level;
+            job.tiled = true;
+            job.tile = level_rect.intersect(dlib::rectangle(
+                left - halo_, top - halo_, right + halo_, bottom + halo_));
+
+            // Cores on the image border extend outwards so windows hanging off
+            // the image edge are kept, as they are in a whole-level scan.
+            job.core = dlib::rectangle(
+                left == 0 ? -unbounded : left,
+                top == 0 ? -unbounded : top,
+                right == width - 1 ? unbounded : right,
+                bottom == height - 1 ? unbounded : bottom);
+            jobs.push_back(job);
+        }
+    }
+}
+
+std::vector<dlib::rectangle> ParallelFaceScanner::operator()(const GrayPyramid& pyramid,
+                                                             double adjust_threshold,
+                                                             unsigned long first_level) {
+    // The coarsest level is always scanned
+    first_level = std::min<unsigned long>(first_level, pyramid.size() - 1);
+
+    std::vector<ScanJob> jobs;
+    for (unsigned long l = first_level; l < pyramid.size(); ++l) {
+        planLevel(l, dlib::get_rect(pyramid.level(l)), jobs);
+    }
+
+    return scanJobs(jobs, [&](const ScanJob& job, std::vector<dlib::rect_detection>& dets) {
+        scanJob(pyramid.level(job.level), job, adjust_threshold, dets);
+    });
+}
+
+std::vector<dlib::rectangle> ParallelFaceScanner::scanJobs(std::vector<ScanJob>& jobs,
+                                                           const JobScanner& scan) const {
+    // Biggest jobs first so the tail of the schedule is made of small ones
+    std::sort(jobs.begin(), jobs.end(), [](const ScanJob& a, const ScanJob& b) {
+        return a.tile.area() > b.tile.area();
+    });
+
+    std::vector<std::vector<dlib::rect_detection>> job_detections(jobs.size());
+    if (pool_) {
+        pool_->parallelFor(jobs.size(), [&](size_t i) { scan(jobs[i], job_detections[i]); });
+    } else {
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            scan(jobs[i], job_detections[i]);
+        }
+    }
+
+    return mergeDetections(job_detections);
+}
+
+std::vector<dlib::rectangle> ParallelFaceScanner::mergeDetections(
+    std::vector<std::vector<dlib::rect_detection>>& job_detections) const {
+    std::vector<dlib::rect_detection> detections;
+    for (auto& dets : job_detections) {
+        detections.insert(detections.end(), dets.begin(), dets.end());
+    }
+
+    // Greedy non-max suppression, highest confidence first, as in object_detector
+    std::sort(detections.rbegin(), detections.rend());
+
+    std::vector<dlib::rectangle> faces;
+    for (const auto& detection : detections) {
+        bool overlaps = false;
+        for (const auto& face : faces) {
+            if (overlap_tester_(face, detection.rect)) {
+                overlaps = true;
+                break;
+            }
+        }
+        if (!overlaps) {
+            faces.push_back(detection.rect);
+        }
+    }
+    return faces;
+}
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,135 @@
+#include "../../include/core/pose_predictor.hpp"
+#include "../../include/core/instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+// Weight of the newest sample in the published residuals
+constexpr double kResidualSmoothing = 0.1;
+
+// Smoothing factor of a first-order low-pass with this cutoff over dt
+double lowPassAlpha(double cutoffHz, double dt) {
+    const double tau = 1.0 / (2.0 * CV_PI * cutoffHz);
+    return 1.0 / (1.0 + tau / dt);
+}
+
+cv::Point2d centroid(const LandmarkArray& landmarks) {
+    cv::Point2d sum;
+    for (const cv::Point2f& p : landmarks) {
+        sum += cv::Point2d(p);
+    }
+    return landmarks.empty() ? sum : sum / static_cast<double>(landmarks.size());
+}
+
+} // namespace
+
+PosePredictor::PosePredictor() : PosePredictor(Config{}) {
+}
+
+PosePredictor::PosePredictor(const Config& config) : config_(config) {
+}
+
+void PosePredictor::reset() {
+    has_face_ = false;
+    landmark_count_ = 0;
+}
+
+void PosePredictor::filter(Channel& channel, double measured, double dt, const FilterParams& params) const {
+    const double velocity = (measured - channel.value) / dt;
+    channel.velocity += lowPassAlpha(config_.derivative_cutoff_hz, dt) * (velocity - channel.velocity);
+    const double cutoff = params.min_cutoff_hz + params.beta * std::abs(channel.velocity);
+    channel.value += lowPassAlpha(cutoff, dt) * (measured - channel.value);
+}
+
+void PosePredictor::update(const FaceDetector::FaceDetectionResult& result, int64_t captureUs) {
+    if (!result.success || result.landmarks.empty()) {
+        reset();
+        return;
+    }
+
+    const cv::Vec3d rvec = result.euler_angles * (CV_PI / 180.0);
+    const size_t count = result.landmarks.size();
+    if (!has_face_ || count != landmark_count_ || captureUs <= last_us_) {
+        // New face: start from the detection, at rest
+        for (size_t i = 0; i < count; ++i) {
+            channels_[2 * i] = Channel{result.landmarks[i].x, 0.0};
+            channels_[2 * i + 1] = Channel{result.landmarks[i].y, 0.0};
+        }
+        for (int k = 0; k < 3; ++k) {
+            channels_[kLandmarkChannels + k] = Channel{rvec[k], 0.0};
+        }
+    } else {
+        // How far off the prediction for this moment was
+        const FaceDetector::FaceDetectionResult predicted = predict(captureUs);
+        double error_px = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            error_px += cv::norm(predicted.landmarks[i] - result.landmarks[i]);
+        }
+        residual_.landmark_px = error_px / count;
+        const cv::Matx33d relative = predicted.rotation_matrix.t() * result.rotation_matrix;
+        const double cos_angle = (relative(0, 0) + relative(1, 1) + relative(2, 2) - 1.0) / 2.0;
+        residual_.rotation_deg = std::acos(std::max(-1.0, std::min(1.0, cos_angle))) * (180.0 / CV_PI);
+
+        smoothed_residual_.landmark_px += kResidualSmoothing * (residual_.landmark_px - smoothed_residual_.landmark_px);
+        smoothed_residual_.rotation_deg += kResidualSmoothing * (residual_.rotation_deg - smoothed_residual_.rotation_deg);
+        Instrumentation::global().set("pose.residual_px", smoothed_residual_.landmark_px);
+        Instrumentation::global().set("pose.residual_deg", smoothed_residual_.rotation_deg);
+
+        const double dt = (captureUs - last_us_) / 1e6;
+        for (size_t i = 0; i < count; ++i) {
+            filter(channels_[2 * i], result.landmarks[i].x, dt, config_.landmarks);
+            filter(channels_[2 * i + 1], result.landmarks[i].y, dt, config_.landmarks);
+        }
+        for (int k = 0; k < 3; ++k) {
+            filter(channels_[kLandmarkChannels + k], rvec[k], dt, config_.rotation);
+        }
+    }
+
+    landmark_count_ = count;
+    last_us_ = captureUs;
+    has_face_ = true;
+
+    // The box follows the filtered landmarks when predicted
+    LandmarkArray filtered;
+    for (size_t i = 0; i < count; ++i) {
+        filtered.emplace_back(static_cast<float>(channels_[2 * i].value),
+                              static_cast<float>(channels_[2 * i + 1].value));
+    }
+    face_rect_ = result.face_rect;
+    rect_anchor_ = centroid(filtered);
+}
+
+FaceDetector::FaceDetectionResult PosePredictor::predict(int64_t atUs) const {
+    FaceDetector::FaceDetectionResult result;
+    if (!has_face_) {
+        return result;
+    }
+
+    const double horizon = std::max(0.0, std::min((atUs - last_us_) / 1e6, config_.max_horizon_ms / 1000.0));
+    for (size_t i = 0; i < landmark_count_; ++i) {
+        const Channel& x = channels_[2 * i];
+        const Channel& y = channels_[2 * i + 1];
+        result.landmarks.emplace_back(static_cast<float>(x.value + x.velocity * horizon),
+                                      static_cast<float>(y.value + y.velocity * horizon));
+    }
+
+    const cv::Point2d shift = centroid(result.landmarks) - rect_anchor_;
+    result.face_rect = face_rect_ + cv::Point(cvRound(shift.x), cvRound(shift.y));
+
+    cv::Vec3d rvec;
+    for (int k = 0; k < 3; ++k) {
+        const Channel& r = channels_[kLandmarkChannels + k];
+        rvec[k] = r.value + r.velocity * horizon;
+    }
+    cv::Rodrigues(rvec, result.rotation_matrix);
+    result.euler_angles = rvec * (180.0 / CV_PI);
+    result.success = true;
+    return result;
+}
+
+} // namespace core
+} // namespace capvision
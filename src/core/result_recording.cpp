@@ -0,0 +1,392 @@
+#include "../../include/core/result_recording.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x52525643;  // "CVRR"
+constexpr uint16_t kFileVersion = 1;
+
+constexpr uint8_t kFlagSuccess = 1;
+constexpr uint8_t kFlagKeyframe = 2;
+
+constexpr double kLandmarkScale = 16.0;
+constexpr double kRotationScale = 32768.0;
+constexpr double kAngleScale = 1000.0;
+constexpr uint64_t kMaxLandmarks = 1024;   // Sanity bound when decoding
+
+// Quantized value layout: rect x, y, w, h | landmarks x, y... | rotation 3x3 | Euler angles
+constexpr size_t kRectValues = 4;
+constexpr size_t kPoseValues = 9 + 3;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    uint32_t magic{kFileMagic};
+    uint16_t version{kFileVersion};
+    uint16_t keyframe_interval{0};
+    int32_t frame_width{0};
+    int32_t frame_height{0};
+    uint64_t frame_count{0};
+    uint64_t index_offset{0};   // 0 until the recorder closes cleanly
+    uint64_t index_count{0};
+};
+#pragma pack(pop)
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t* data, size_t end, size_t& cursor, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        const uint8_t byte = data[cursor++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int32_t quantize(double value, double scale) {
+    return static_cast<int32_t>(std::lround(value * scale));
+}
+
+void quantize(const FaceDetector::FaceDetectionResult& result, std::vector<int32_t>& values) {
+    values.clear();
+    values.push_back(result.face_rect.x);
+    values.push_back(result.face_rect.y);
+    values.push_back(result.face_rect.width);
+    values.push_back(result.face_rect.height);
+    for (const auto& point : result.landmarks) {
+        values.push_back(quantize(point.x, kLandmarkScale));
+        values.push_back(quantize(point.y, kLandmarkScale));
+    }
+    for (int i = 0; i < 9; ++i) {
+        values.push_back(quantize(result.rotation_matrix.val[i], kRotationScale));
+    }
+    for (int i = 0; i < 3; ++i) {
+        values.push_back(quantize(result.euler_angles[i], kAngleScale));
+    }
+}
+
+void dequantize(const std::vector<int32_t>& values, FaceDetector::FaceDetectionResult& result) {
+    const size_t landmark_count = (values.size() - kRectValues - kPoseValues) / 2;
+    result.face_rect = cv::Rect(values[0], values[1], values[2], values[3]);
+
+    // Points past the result's capacity are skipped
+    result.landmarks.resize(landmark_count);
+    const int32_t* landmarks = values.data() + kRectValues;
+    for (size_t i = 0; i < result.landmarks.size(); ++i) {
+        result.landmarks[i] = cv::Point2f(static_cast<float>(landmarks[2 * i] / kLandmarkScale),
+                                          static_cast<float>(landmarks[2 * i + 1] / kLandmarkScale));
+    }
+
+    const int32_t* pose = landmarks + 2 * landmark_count;
+    for (int i = 0; i < 9; ++i) {
+        result.rotation_matrix.val[i] = pose[i] / kRotationScale;
+    }
+    for (int i = 0; i < 3; ++i) {
+        result.euler_angles[i] = pose[9 + i] / kAngleScale;
+    }
+}
+
+} // namespace
+
+ResultRecorder::ResultRecorder() = default;
+
+ResultRecorder::~ResultRecorder() {
+    close();
+}
+
+bool ResultRecorder::open(const std::string& path, const Options& options) {
+    close();
+
+    options_ = options;
+    options_.keyframe_interval = std::max(1u, std::min(options.keyframe_interval, 0xffffu));
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to create recording " << path << std::endl;
+        return false;
+    }
+
+    // Placeholder header; close() fills in the counts and the index offset
+    FileHeader header;
+    header.keyframe_interval = static_cast<uint16_t>(options_.keyframe_interval);
+    header.frame_width = options_.frame_width;
+    header.frame_height = options_.frame_height;
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    frame_count_ = 0;
+    offset_ = sizeof(header);
+    last_timestamp_us_ = 0;
+    reference_.clear();
+    index_.clear();
+    return file_.good();
+}
+
+bool ResultRecorder::append(int64_t timestampUs, const FaceDetector::FaceDetectionResult& result) {
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    const bool keyframe = frame_count_ % options_.keyframe_interval == 0;
+    if (keyframe) {
+        index_.push_back({frame_count_, offset_, timestampUs});
+        std::fill(reference_.begin(), reference_.end(), 0);
+    }
+
+    record_.clear();
+    record_.push_back(static_cast<uint8_t>((result.success ? kFlagSuccess : 0) |
+                                           (keyframe ? kFlagKeyframe : 0)));
+    putVarint(record_, zigzag(keyframe ? timestampUs : timestampUs - last_timestamp_us_));
+    last_timestamp_us_ = timestampUs;
+
+    if (result.success) {
+        quantize(result, values_);
+        putVarint(record_, result.landmarks.size());
+        if (reference_.size() != values_.size()) {
+            reference_.assign(values_.size(), 0);
+        }
+        for (size_t i = 0; i < values_.size(); ++i) {
+            putVarint(record_, zigzag(static_cast<int64_t>(values_[i]) - reference_[i]));
+        }
+        reference_.swap(values_);
+    }
+
+    file_.write(reinterpret_cast<const char*>(record_.data()), record_.size());
+    offset_ += record_.size();
+    ++frame_count_;
+    return file_.good();
+}
+
+bool ResultRecorder::close() {
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    FileHeader header;
+    header.keyframe_interval = static_cast<uint16_t>(options_.keyframe_interval);
+    header.frame_width = options_.frame_width;
+    header.frame_height = options_.frame_height;
+    header.frame_count = frame_count_;
+    header.index_offset = offset_;
+    header.index_count = index_.size();
+
+    file_.write(reinterpret_cast<const char*>(index_.data()), index_.size() * sizeof(IndexEntry));
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const bool ok = file_.good();
+    file_.close();
+    return ok;
+}
+
+ResultReplay::ResultReplay() = default;
+
+ResultReplay::~ResultReplay() {
+    close();
+}
+
+bool ResultReplay::open(const std::string& path) {
+    close();
+
+#ifndef _WIN32
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            mapping_ = address;
+            data_ = static_cast<const uint8_t*>(address);
+            size_ = static_cast<size_t>(info.st_size);
+        }
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#else
+    std::ifstream file(path, std::ios::binary);
+    buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (!buffer_.empty()) {
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+#endif
+
+    FileHeader header;
+    if (!data_ || size_ < sizeof(header)) {
+        std::cerr << "Failed to read recording " << path << std::endl;
+        close();
+        return false;
+    }
+    std::memcpy(&header, data_, sizeof(header));
+    if (header.magic != kFileMagic || header.version != kFileVersion) {
+        std::cerr << path << " is not a CapVision result recording" << std::endl;
+        close();
+        return false;
+    }
+
+    frame_width_ = header.frame_width;
+    frame_height_ = header.frame_height;
+
+    const uint64_t index_bytes = header.index_count * sizeof(IndexEntry);
+    if (header.index_offset >= sizeof(header) && header.index_offset <= size_ &&
+        index_bytes <= size_ - header.index_offset) {
+        records_end_ = header.index_offset;
+        frame_count_ = header.frame_count;
+        index_.resize(header.index_count);
+        std::memcpy(index_.data(), data_ + header.index_offset, index_bytes);
+    } else {
+        // Recorder did not close: recover everything up to the last whole record
+        rebuildIndex();
+    }
+
+    first_timestamp_us_ = index_.empty() ? 0 : index_.front().timestamp_us;
+    return seek(0);
+}
+
+void ResultReplay::close() {
+#ifndef _WIN32
+    if (mapping_) {
+        munmap(mapping_, size_);
+    }
+#endif
+    mapping_ = nullptr;
+    buffer_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    records_end_ = 0;
+    frame_count_ = 0;
+    index_.clear();
+    cursor_ = 0;
+    next_frame_ = 0;
+}
+
+void ResultReplay::rebuildIndex() {
+    index_.clear();
+    records_end_ = size_;
+    cursor_ = sizeof(FileHeader);
+    next_frame_ = 0;
+
+    while (cursor_ < records_end_) {
+        const size_t offset = cursor_;
+        const bool keyframe = (data_[offset] & kFlagKeyframe) != 0;
+        if (!decodeRecord(nullptr)) {
+            records_end_ = offset;
+            break;
+        }
+        if (keyframe) {
+            index_.push_back({next_frame_ - 1, offset, last_timestamp_us_});
+        }
+    }
+    frame_count_ = next_frame_;
+}
+
+bool ResultReplay::seek(uint64_t frame) {
+    if (!data_ || frame > frame_count_) {
+        return false;
+    }
+
+    if (frame == frame_count_) {
+        cursor_ = records_end_;
+        next_frame_ = frame;
+        return true;
+    }
+
+    auto keyframe = std::upper_bound(index_.begin(), index_.end(), frame,
+        [](uint64_t value, const IndexEntry& entry) { return value < entry.frame; });
+    if (keyframe == index_.begin()) {
+        return false;
+    }
+    --keyframe;
+
+    cursor_ = keyframe->offset;
+    next_frame_ = keyframe->frame;
+    while (next_frame_ < frame) {
+        if (!decodeRecord(nullptr)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ResultReplay::next(RecordedFrame& frame) {
+    return next_frame_ < frame_count_ && decodeRecord(&frame);
+}
+
+bool ResultReplay::decodeRecord(RecordedFrame* frame) {
+    if (cursor_ >= records_end_) {
+        return false;
+    }
+
+    const uint8_t flags = data_[cursor_++];
+    uint64_t raw;
+    if (!getVarint(data_, records_end_, cursor_, raw)) {
+        return false;
+    }
+    const int64_t delta = unzigzag(raw);
+    last_timestamp_us_ = (flags & kFlagKeyframe) ? delta : last_timestamp_us_ + delta;
+    if (flags & kFlagKeyframe) {
+        std::fill(reference_.begin(), reference_.end(), 0);
+    }
+
+    const bool success = (flags & kFlagSuccess) != 0;
+    if (success) {
+        uint64_t landmark_count;
+        if (!getVarint(data_, records_end_, cursor_, landmark_count) || landmark_count > kMaxLandmarks) {
+            return false;
+        }
+        const size_t value_count = kRectValues + 2 * landmark_count + kPoseValues;
+        if (reference_.size() != value_count) {
+            reference_.assign(value_count, 0);
+        }
+        for (auto& value : reference_) {
+            if (!getVarint(data_, records_end_, cursor_, raw)) {
+                return false;
+            }
+            value = static_cast<int32_t>(value + unzigzag(raw));
+        }
+    }
+
+    if (frame) {
+        frame->timestamp_us = last_timestamp_us_;
+        frame->index = next_frame_;
+        frame->result.success = success;
+        if (success) {
+            dequantize(reference_, frame->result);
+        } else {
+            frame->result = FaceDetector::FaceDetectionResult{};
+        }
+    }
+    ++next_frame_;
+    return true;
+}
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,298 @@
+#include "../../include/core/shared_frame_ring.hpp"
+
+#ifndef _WIN32
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <unistd.h>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+constexpr uint32_t kRingMagic = 0x474e5243;  // "CRNG"
+constexpr uint32_t kRingVersion = 1;
+constexpr size_t kCacheLine = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory counters must be lock-free");
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+int matType(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::BGR: return CV_8UC3;
+    case PixelFormat::YUYV: return CV_8UC2;
+    default: return CV_8UC1;
+    }
+}
+
+} // namespace
+
+// Each counter has its own cache line so the two processes do not fight
+// over lines they never both write
+struct SharedFrameRing::ControlBlock {
+    std::atomic<uint32_t> magic;    // Set last, once the layout below is valid
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_capacity;
+    uint32_t result_count;
+
+    alignas(kCacheLine) std::atomic<uint64_t> frame_write;   // Producer
+    alignas(kCacheLine) std::atomic<uint64_t> frame_read;    // Consumer
+    alignas(kCacheLine) std::atomic<uint64_t> result_write;  // Consumer
+    alignas(kCacheLine) std::atomic<uint64_t> result_read;   // Producer
+    alignas(kCacheLine) std::atomic<uint64_t> frames_dropped;
+    std::atomic<uint64_t> results_dropped;
+};
+
+struct alignas(kCacheLine) SharedFrameRing::SlotHeader {
+    uint64_t sequence;
+    int64_t timestamp_us;
+    int32_t width;
+    int32_t height;
+    uint64_t stride;
+    uint32_t format;
+};
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::create(const std::string& name, const Layout& layout) {
+    std::unique_ptr<SharedFrameRing> ring(new SharedFrameRing());
+    ring->name_ = name;
+    ring->layout_ = layout;
+    ring->layout_.slot_count = std::max(1u, layout.slot_count);
+    ring->layout_.result_count = std::max(1u, layout.result_count);
+
+    const size_t slot_stride = alignUp(sizeof(SlotHeader) + ring->layout_.slot_capacity, kCacheLine);
+    const size_t results_offset = alignUp(sizeof(ControlBlock), kCacheLine) +
+                                  slot_stride * ring->layout_.slot_count;
+    const size_t size = results_offset + sizeof(ResultRecord) * ring->layout_.result_count;
+
+    // A stale segment from a crashed run would carry an old layout
+    shm_unlink(name.c_str());
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "SharedFrameRing " << name << ": shm_open failed: " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    ring->owner_ = true;
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0 || !ring->map(fd, size)) {
+        std::cerr << "SharedFrameRing " << name << ": cannot size the segment" << std::endl;
+        close(fd);
+        return nullptr;
+    }
+    close(fd);
+
+    // ftruncate zero-fills, which is already a valid empty ring
+    auto* control = new (ring->base_) ControlBlock();
+    control->version = kRingVersion;
+    control->slot_count = ring->layout_.slot_count;
+    control->slot_capacity = ring->layout_.slot_capacity;
+    control->result_count = ring->layout_.result_count;
+    control->magic.store(kRingMagic, std::memory_order_release);
+
+    ring->control_ = control;
+    ring->slot_stride_ = slot_stride;
+    ring->results_offset_ = results_offset;
+    return ring;
+}
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::attach(const std::string& name) {
+    const int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat info;
+    std::unique_ptr<SharedFrameRing> ring(new SharedFrameRing());
+    ring->name_ = name;
+    if (fstat(fd, &info) < 0 || static_cast<size_t>(info.st_size) < sizeof(ControlBlock) ||
+        !ring->map(fd, static_cast<size_t>(info.st_size))) {
+        close(fd);
+        return nullptr;
+    }
+    close(fd);
+
+    auto* control = reinterpret_cast<ControlBlock*>(ring->base_);
+    if (control->magic.load(std::memory_order_acquire) != kRingMagic ||
+        control->version != kRingVersion) {
+        return nullptr;
+    }
+
+    ring->layout_.slot_count = control->slot_count;
+    ring->layout_.slot_capacity = control->slot_capacity;
+    ring->layout_.result_count = control->result_count;
+    ring->slot_stride_ = alignUp(sizeof(SlotHeader) + control->slot_capacity, kCacheLine);
+    ring->results_offset_ = alignUp(sizeof(ControlBlock), kCacheLine) +
+                            ring->slot_stride_ * control->slot_count;
+    if (ring->results_offset_ + sizeof(ResultRecord) * control->result_count > ring->size_) {
+        return nullptr;
+    }
+
+    ring->control_ = control;
+    return ring;
+}
+
+SharedFrameRing::~SharedFrameRing() {
+    releaseFrame();
+    if (base_) {
+        munmap(base_, size_);
+    }
+    if (owner_) {
+        shm_unlink(name_.c_str());
+    }
+}
+
+bool SharedFrameRing::map(int fd, size_t size) {
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(address);
+    size_ = size;
+    return true;
+}
+
+SharedFrameRing::SlotHeader* SharedFrameRing::slot(uint64_t index) const {
+    const size_t offset = alignUp(sizeof(ControlBlock), kCacheLine) +
+                          slot_stride_ * (index % layout_.slot_count);
+    return reinterpret_cast<SlotHeader*>(base_ + offset);
+}
+
+SharedFrameRing::ResultRecord* SharedFrameRing::result(uint64_t index) const {
+    return reinterpret_cast<ResultRecord*>(
+        base_ + results_offset_ + sizeof(ResultRecord) * (index % layout_.result_count));
+}
+
+uint8_t* SharedFrameRing::beginFrame() {
+    const uint64_t write = control_->frame_write.load(std::memory_order_relaxed);
+    const uint64_t read = control_->frame_read.load(std::memory_order_acquire);
+    if (write - read >= layout_.slot_count) {
+        control_->frames_dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return reinterpret_cast<uint8_t*>(slot(write) + 1);
+}
+
+bool SharedFrameRing::commitFrame(int width, int height, size_t stride, PixelFormat format,
+                                  int64_t timestampUs, uint64_t sequence) {
+    if (width <= 0 || height <= 0 || stride * static_cast<size_t>(height) > layout_.slot_capacity) {
+        std::cerr << "SharedFrameRing " << name_ << ": frame does not fit a slot" << std::endl;
+        return false;
+    }
+
+    const uint64_t write = control_->frame_write.load(std::memory_order_relaxed);
+    SlotHeader* header = slot(write);
+    header->sequence = sequence;
+    header->timestamp_us = timestampUs;
+    header->width = width;
+    header->height = height;
+    header->stride = stride;
+    header->format = static_cast<uint32_t>(format);
+    control_->frame_write.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+bool SharedFrameRing::readResult(ResultRecord& record) {
+    const uint64_t read = control_->result_read.load(std::memory_order_relaxed);
+    const uint64_t write = control_->result_write.load(std::memory_order_acquire);
+    if (read == write) {
+        return false;
+    }
+    record = *result(read);
+    control_->result_read.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+bool SharedFrameRing::acquireFrame(CapturedFrame& frame, bool newestOnly) {
+    releaseFrame();
+
+    const uint64_t write = control_->frame_write.load(std::memory_order_acquire);
+    uint64_t read = control_->frame_read.load(std::memory_order_relaxed);
+    if (read == write) {
+        return false;
+    }
+    if (newestOnly && write - read > 1) {
+        // Hand the skipped slots back to the producer right away
+        read = write - 1;
+        control_->frame_read.store(read, std::memory_order_release);
+    }
+
+    const SlotHeader* header = slot(read);
+    const auto format = static_cast<PixelFormat>(header->format);
+    frame.image = cv::Mat(header->height, header->width, matType(format),
+                          const_cast<SlotHeader*>(header) + 1, header->stride);
+    frame.format = format;
+    frame.timestamp_us = header->timestamp_us;
+    frame.sequence = header->sequence;
+
+    holding_ = true;
+    held_index_ = read;
+    return true;
+}
+
+void SharedFrameRing::releaseFrame() {
+    if (!holding_) {
+        return;
+    }
+    control_->frame_read.store(held_index_ + 1, std::memory_order_release);
+    holding_ = false;
+}
+
+bool SharedFrameRing::writeResult(uint64_t frameSequence, int64_t timestampUs,
+                                  const FaceDetector::FaceDetectionResult& detection) {
+    const uint64_t write = control_->result_write.load(std::memory_order_relaxed);
+    const uint64_t read = control_->result_read.load(std::memory_order_acquire);
+    if (write - read >= layout_.result_count) {
+        control_->results_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ResultRecord& record = *result(write);
+    record.frame_sequence = frameSequence;
+    record.timestamp_us = timestampUs;
+    record.success = detection.success ? 1 : 0;
+    record.face_rect[0] = detection.face_rect.x;
+    record.face_rect[1] = detection.face_rect.y;
+    record.face_rect[2] = detection.face_rect.width;
+    record.face_rect[3] = detection.face_rect.height;
+
+    record.landmark_count = static_cast<uint32_t>(
+        std::min<size_t>(detection.landmarks.size(), kMaxLandmarks));
+    for (uint32_t i = 0; i < record.landmark_count; ++i) {
+        record.landmarks[2 * i] = detection.landmarks[i].x;
+        record.landmarks[2 * i + 1] = detection.landmarks[i].y;
+    }
+
+    for (int i = 0; i < 9; ++i) {
+        record.rotation_matrix[i] = detection.rotation_matrix.val[i];
+    }
+    for (int i = 0; i < 3; ++i) {
+        record.euler_angles[i] = detection.euler_angles[i];
+    }
+
+    control_->result_write.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+uint64_t SharedFrameRing::framesDropped() const {
+    return control_->frames_dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t SharedFrameRing::resultsDropped() const {
+    return control_->results_dropped.load(std::memory_order_relaxed);
+}
+
+} // namespace core
+} // namespace capvision
+
+#endif
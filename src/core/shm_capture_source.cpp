@@ -0,0 +1,71 @@
+#include "../../include/core/shm_capture_source.hpp"
+
+#ifndef _WIN32
+
+#include <chrono>
+#include <thread>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+// Polling interval while waiting for the producer; well under a frame time
+constexpr auto kPollInterval = std::chrono::microseconds(250);
+
+} // namespace
+
+ShmCaptureSource::ShmCaptureSource(const std::string& name)
+    : ShmCaptureSource(name, Options{}) {
+}
+
+ShmCaptureSource::ShmCaptureSource(const std::string& name, const Options& options)
+    : name_(name)
+    , options_(options) {
+}
+
+ShmCaptureSource::~ShmCaptureSource() {
+    close();
+}
+
+bool ShmCaptureSource::open() {
+    close();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options_.timeout_ms);
+    while (!(ring_ = SharedFrameRing::attach(name_))) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+void ShmCaptureSource::close() {
+    ring_.reset();
+}
+
+bool ShmCaptureSource::read(CapturedFrame& frame) {
+    if (!ring_) {
+        return false;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options_.timeout_ms);
+    while (!ring_->acquireFrame(frame, options_.newest_only)) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(kPollInterval);
+    }
+    return true;
+}
+
+bool ShmCaptureSource::publishResult(const CapturedFrame& frame,
+                                     const FaceDetector::FaceDetectionResult& result) {
+    return ring_ && ring_->writeResult(frame.sequence, frame.timestamp_us, result);
+}
+
+} // namespace core
+} // namespace capvision
+
+#endif
@@ -0,0 +1,233 @@
+#include "../../include/core/stream_engine.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+constexpr size_t kLatencyWindow = 512;
+
+} // namespace
+
+StreamEngine::StreamEngine(const Config& config)
+    : config_(config) {
+    if (config_.worker_count == 0) {
+        config_.worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+StreamEngine::~StreamEngine() {
+    stop();
+}
+
+size_t StreamEngine::addStream(std::unique_ptr<CaptureSource> source, ResultCallback callback) {
+    auto stream = std::make_unique<Stream>();
+    stream->source = std::move(source);
+    stream->callback = std::move(callback);
+    stream->latencies_ms.reserve(kLatencyWindow);
+    streams_.push_back(std::move(stream));
+    return streams_.size() - 1;
+}
+
+bool StreamEngine::start() {
+    if (running_ || streams_.empty()) {
+        return false;
+    }
+
+    for (auto& stream : streams_) {
+        if (!stream->source->isOpened() && !stream->source->open()) {
+            std::cerr << "StreamEngine: failed to open a capture source" << std::endl;
+            return false;
+        }
+    }
+
+    // Streams are already spread over the workers, so each detector scans
+    // its pyramid on its own thread
+    detectors_.clear();
+    for (size_t i = 0; i < config_.worker_count; ++i) {
+        auto detector = std::make_unique<FaceDetector>();
+        detector->setDetectionPool(nullptr);
+        if (!detector->initialize()) {
+            return false;
+        }
+        detectors_.push_back(std::move(detector));
+    }
+
+    running_ = true;
+    start_us_ = steadyNowMicros();
+    total_processed_ = 0;
+
+    for (auto& detector : detectors_) {
+        workers_.emplace_back(&StreamEngine::workerLoop, this, std::ref(*detector));
+    }
+    for (auto& stream : streams_) {
+        stream->capture_thread = std::thread(&StreamEngine::captureLoop, this, std::ref(*stream));
+    }
+    return true;
+}
+
+void StreamEngine::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    work_available_.notify_all();
+
+    for (auto& stream : streams_) {
+        if (stream->capture_thread.joinable()) {
+            stream->capture_thread.join();
+        }
+    }
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void StreamEngine::captureLoop(Stream& stream) {
+    CapturedFrame frame;
+    CapturedFrame staging;
+    while (running_) {
+        if (!stream.source->read(frame)) {
+            // End of a file source ends the stream; a camera timeout does not
+            if (!stream.source->isOpened()) {
+                return;
+            }
+            continue;
+        }
+
+        // The source may lend out its own buffer, so the mailbox keeps a copy;
+        // staging and the mailbox swap buffers, so neither reallocates
+        frame.image.copyTo(staging.image);
+        staging.format = frame.format;
+        staging.timestamp_us = frame.timestamp_us;
+        staging.sequence = frame.sequence;
+
+        bool replaced = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::swap(staging, stream.pending);
+            replaced = stream.has_pending;
+            stream.has_pending = true;
+        }
+        work_available_.notify_one();
+
+        std::lock_guard<std::mutex> lock(stream.stats_mutex);
+        ++stream.frames_captured;
+        if (replaced) {
+            ++stream.frames_dropped;
+        }
+    }
+}
+
+void StreamEngine::workerLoop(FaceDetector& detector) {
+    CapturedFrame frame;
+    for (;;) {
+        Stream* stream = nullptr;
+        size_t stream_id = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [&] {
+                if (!running_) {
+                    return true;
+                }
+                for (size_t n = 0; n < streams_.size(); ++n) {
+                    const size_t candidate = (next_stream_ + n) % streams_.size();
+                    if (streams_[candidate]->has_pending && !streams_[candidate]->in_flight) {
+                        stream_id = candidate;
+                        return true;
+                    }
+                }
+                return false;
+            });
+            if (!running_) {
+                return;
+            }
+
+            stream = streams_[stream_id].get();
+            next_stream_ = (stream_id + 1) % streams_.size();
+            std::swap(frame, stream->pending);
+            stream->has_pending = false;
+            stream->in_flight = true;
+        }
+
+        const double age_ms = (steadyNowMicros() - frame.timestamp_us) / 1000.0;
+        if (age_ms > config_.latency_budget_ms) {
+            std::lock_guard<std::mutex> lock(stream->stats_mutex);
+            ++stream->frames_dropped;
+        } else {
+            StreamResult result;
+            result.stream_id = stream_id;
+            result.sequence = frame.sequence;
+            result.capture_us = frame.timestamp_us;
+            result.face = detector.detectFace(frame.image);
+            result.completed_us = steadyNowMicros();
+
+            if (stream->callback) {
+                stream->callback(result);
+            }
+            recordLatency(*stream, (result.completed_us - result.capture_us) / 1000.0);
+            ++total_processed_;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stream->in_flight = false;
+        }
+        // A frame of this stream may have arrived while it was in flight
+        work_available_.notify_one();
+    }
+}
+
+void StreamEngine::recordLatency(Stream& stream, double latency_ms) {
+    std::lock_guard<std::mutex> lock(stream.stats_mutex);
+    ++stream.frames_processed;
+    if (stream.latencies_ms.size() < kLatencyWindow) {
+        stream.latencies_ms.push_back(latency_ms);
+    } else {
+        stream.latencies_ms[stream.latency_cursor] = latency_ms;
+        stream.latency_cursor = (stream.latency_cursor + 1) % kLatencyWindow;
+    }
+}
+
+StreamEngine::StreamStats StreamEngine::stats(size_t streamId) const {
+    const Stream& stream = *streams_.at(streamId);
+
+    StreamStats stats;
+    std::vector<double> latencies;
+    {
+        std::lock_guard<std::mutex> lock(stream.stats_mutex);
+        stats.frames_captured = stream.frames_captured;
+        stats.frames_processed = stream.frames_processed;
+        stats.frames_dropped = stream.frames_dropped;
+        latencies = stream.latencies_ms;
+    }
+
+    if (latencies.empty()) {
+        return stats;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0.0;
+    for (double latency : latencies) {
+        sum += latency;
+    }
+    stats.mean_latency_ms = sum / latencies.size();
+    stats.p50_latency_ms = latencies[latencies.size() / 2];
+    stats.p95_latency_ms = latencies[std::min(latencies.size() - 1, latencies.size() * 95 / 100)];
+    stats.max_latency_ms = latencies.back();
+    return stats;
+}
+
+double StreamEngine::throughputFps() const {
+    const double elapsed_s = (steadyNowMicros() - start_us_) / 1e6;
+    return elapsed_s > 0.0 ? total_processed_.load() / elapsed_s : 0.0;
+}
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,106 @@
+#include "../../include/core/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace capvision {
+namespace core {
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    condition_.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (stopping_ && tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+
+    // Helpers that start after every index has been claimed exit without
+    // touching body, so capturing it by reference is safe.
+    auto work = [state, &body, count]() {
+        size_t index;
+        while ((index = state->next.fetch_add(1)) < count) {
+            try {
+                body(index);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+
+            if (state->done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(count - 1, workers_.size());
+    for (size_t i = 0; i < helpers; ++i) {
+        enqueue(work);
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, count] { return state->done.load() == count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} // namespace core
+} // namespace capvision
@@ -0,0 +1,253 @@
+#include "../../include/core/v4l2_capture_source.hpp"
+
+#ifdef __linux__
+
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <unistd.h>
+
+namespace capvision {
+namespace core {
+
+namespace {
+
+int xioctl(int fd, unsigned long request, void* arg) {
+    int r;
+    do {
+        r = ioctl(fd, request, arg);
+    } while (r == -1 && errno == EINTR);
+    return r;
+}
+
+} // namespace
+
+V4l2CaptureSource::V4l2CaptureSource(const Options& options)
+    : options_(options) {
+}
+
+V4l2CaptureSource::~V4l2CaptureSource() {
+    close();
+}
+
+void V4l2CaptureSource::fail(const char* what) {
+    std::cerr << "V4L2 " << options_.device << ": " << what << " failed: "
+              << std::strerror(errno) << std::endl;
+}
+
+bool V4l2CaptureSource::open() {
+    close();
+
+    // Non-blocking so read() can drain every completed buffer and keep the newest
+    fd_ = ::open(options_.device.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    v4l2_capability caps{};
+    if (xioctl(fd_, VIDIOC_QUERYCAP, &caps) < 0 ||
+        !(caps.capabilities & V4L2_CAP_VIDEO_CAPTURE) ||
+        !(caps.capabilities & V4L2_CAP_STREAMING)) {
+        close();
+        return false;
+    }
+
+    if (!configureFormat() || !mapBuffers()) {
+        close();
+        return false;
+    }
+
+    for (unsigned int i = 0; i < buffers_.size(); ++i) {
+        if (!queueBuffer(i)) {
+            close();
+            return false;
+        }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd_, VIDIOC_STREAMON, &type) < 0) {
+        fail("VIDIOC_STREAMON");
+        close();
+        return false;
+    }
+
+    streaming_ = true;
+    return true;
+}
+
+bool V4l2CaptureSource::configureFormat() {
+    v4l2_format fmt{};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = options_.width;
+    fmt.fmt.pix.height = options_.height;
+    fmt.fmt.pix.pixelformat = options_.format == PixelFormat::MJPEG ? V4L2_PIX_FMT_MJPEG
+                                                                    : V4L2_PIX_FMT_YUYV;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (xioctl(fd_, VIDIOC_S_FMT, &fmt) < 0) {
+        fail("VIDIOC_S_FMT");
+        return false;
+    }
+
+    const bool mjpeg = fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_MJPEG;
+    if (!mjpeg && fmt.fmt.pix.pixelformat != V4L2_PIX_FMT_YUYV) {
+        std::cerr << "V4L2 " << options_.device << ": unsupported pixel format" << std::endl;
+        return false;
+    }
+    options_.format = mjpeg ? PixelFormat::MJPEG : PixelFormat::YUYV;
+
+    // The driver may have picked the nearest supported size
+    width_ = static_cast<int>(fmt.fmt.pix.width);
+    height_ = static_cast<int>(fmt.fmt.pix.height);
+    bytes_per_line_ = fmt.fmt.pix.bytesperline ? fmt.fmt.pix.bytesperline
+                                               : static_cast<size_t>(width_) * 2;
+
+    // Frame rate is only a request; not every driver supports it
+    v4l2_streamparm parm{};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = options_.fps;
+    xioctl(fd_, VIDIOC_S_PARM, &parm);
+    return true;
+}
+
+bool V4l2CaptureSource::mapBuffers() {
+    v4l2_requestbuffers req{};
+    req.count = options_.buffer_count;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd_, VIDIOC_REQBUFS, &req) < 0 || req.count < 1) {
+        fail("VIDIOC_REQBUFS");
+        return false;
+    }
+
+    buffers_.resize(req.count);
+    for (unsigned int i = 0; i < req.count; ++i) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (xioctl(fd_, VIDIOC_QUERYBUF, &buf) < 0) {
+            fail("VIDIOC_QUERYBUF");
+            return false;
+        }
+
+        void* start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, buf.m.offset);
+        if (start == MAP_FAILED) {
+            fail("mmap");
+            return false;
+        }
+        buffers_[i].start = start;
+        buffers_[i].length = buf.length;
+    }
+    return true;
+}
+
+bool V4l2CaptureSource::queueBuffer(unsigned int index) {
+    v4l2_buffer buf{};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+    if (xioctl(fd_, VIDIOC_QBUF, &buf) < 0) {
+        fail("VIDIOC_QBUF");
+        return false;
+    }
+    return true;
+}
+
+void V4l2CaptureSource::close() {
+    if (streaming_) {
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(fd_, VIDIOC_STREAMOFF, &type);
+        streaming_ = false;
+    }
+
+    for (auto& buffer : buffers_) {
+        if (buffer.start) {
+            munmap(buffer.start, buffer.length);
+        }
+    }
+    buffers_.clear();
+    held_index_ = -1;
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool V4l2CaptureSource::read(CapturedFrame& frame) {
+    if (!streaming_) {
+        return false;
+    }
+
+    // The previous frame goes back to the driver; the caller is done with it
+    if (held_index_ >= 0) {
+        queueBuffer(static_cast<unsigned int>(held_index_));
+        held_index_ = -1;
+    }
+
+    pollfd pfd{};
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+    int ready;
+    do {
+        ready = poll(&pfd, 1, options_.timeout_ms);
+    } while (ready < 0 && errno == EINTR);
+    if (ready <= 0) {
+        return false;
+    }
+
+    // Drain every completed buffer, requeueing all but the newest
+    v4l2_buffer latest{};
+    bool have_frame = false;
+    for (;;) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(fd_, VIDIOC_DQBUF, &buf) < 0) {
+            if (errno == EAGAIN) {
+                break;
+            }
+            fail("VIDIOC_DQBUF");
+            return false;
+        }
+
+        if (have_frame) {
+            queueBuffer(latest.index);
+        }
+        latest = buf;
+        have_frame = true;
+    }
+    if (!have_frame) {
+        return false;
+    }
+    held_index_ = static_cast<int>(latest.index);
+
+    void* data = buffers_[latest.index].start;
+    if (options_.format == PixelFormat::MJPEG) {
+        frame.image = cv::Mat(1, static_cast<int>(latest.bytesused), CV_8UC1, data);
+    } else {
+        frame.image = cv::Mat(height_, width_, CV_8UC2, data, bytes_per_line_);
+    }
+    frame.format = options_.format;
+    frame.sequence = latest.sequence;
+
+    // Kernel timestamps share CLOCK_MONOTONIC with std::chrono::steady_clock
+    if ((latest.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+        frame.timestamp_us = static_cast<int64_t>(latest.timestamp.tv_sec) * 1000000 +
+                             latest.timestamp.tv_usec;
+    } else {
+        frame.timestamp_us = steadyNowMicros();
+    }
+    return true;
+}
+
+} // namespace core
+} // namespace capvision
+
+#endif
@@ -1,10 +1,63 @@
 #include "../include/ui/main_window.hpp"
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[]) {
+    // The render thread's context (--render-thread) shares with this one
+    QApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
     QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption yuvOption("yuv", "Keep YUYV camera frames in YUV end to end (no CPU overlays).");
+    parser.addOption(yuvOption);
+    QCommandLineOption shmOption("shm", "Read frames from the shared-memory ring <name> instead of the camera.", "name");
+    parser.addOption(shmOption);
+    QCommandLineOption recordOption("record", "Record detection results to <file>.", "file");
+    parser.addOption(recordOption);
+    QCommandLineOption replayOption("replay", "Replay recorded results from <file> without running detection.", "file");
+    parser.addOption(replayOption);
+    QCommandLineOption replayVideoOption("replay-video", "Video shown behind the replayed results.", "file");
+    parser.addOption(replayVideoOption);
+    QCommandLineOption warmLandmarksOption("warm-landmarks", "Warm-start landmarks from the previous frame (fewer cascade levels).");
+    parser.addOption(warmLandmarksOption);
+    QCommandLineOption budgetOption("frame-budget", "Per-frame budget in ms that quality is lowered to meet; 0 disables (default 33.3).", "ms");
+    parser.addOption(budgetOption);
+    QCommandLineOption statsOption("stats", "Print pipeline instrumentation once a second.");
+    parser.addOption(statsOption);
+    QCommandLineOption predictPoseOption("predict-pose", "Filter the pose and extrapolate it to display time.");
+    parser.addOption(predictPoseOption);
+    QCommandLineOption poseLeadOption("pose-lead", "With --predict-pose, extrapolate this many ms past the frame's capture time (default 0).", "ms");
+    parser.addOption(poseLeadOption);
+    QCommandLineOption gpuTimersOption("gpu-timers", "Time the render passes on the GPU (gpu.* in --stats); F3 toggles.");
+    parser.addOption(gpuTimersOption);
+    QCommandLineOption motionGateOption("motion-gate", "Skip detection on static frames and rescan slowly while no face is seen.");
+    parser.addOption(motionGateOption);
+    QCommandLineOption trackFacesOption("track-faces", "Track every face in view and put a cap on each.");
+    parser.addOption(trackFacesOption);
+    QCommandLineOption renderThreadOption("render-thread", "Render and present on a dedicated thread with its own GL context.");
+    parser.addOption(renderThreadOption);
+    parser.process(app);
+
+    capvision::ui::MainWindow::Options options;
+    options.yuvPipeline = parser.isSet(yuvOption);
+    options.shmName = parser.value(shmOption).toStdString();
+    options.recordPath = parser.value(recordOption).toStdString();
+    options.replayPath = parser.value(replayOption).toStdString();
+    options.replayVideoPath = parser.value(replayVideoOption).toStdString();
+    options.warmLandmarks = parser.isSet(warmLandmarksOption);
+    if (parser.isSet(budgetOption)) {
+        options.frameBudgetMs = parser.value(budgetOption).toDouble();
+    }
+    options.printStats = parser.isSet(statsOption);
+    options.predictPose = parser.isSet(predictPoseOption);
+    options.poseLeadMs = parser.value(poseLeadOption).toDouble();
+    options.gpuTimers = parser.isSet(gpuTimersOption);
+    options.motionGate = parser.isSet(motionGateOption);
+    options.trackFaces = parser.isSet(trackFacesOption);
+    options.renderThread = parser.isSet(renderThreadOption);
     
-    capvision::ui::MainWindow mainWindow;
+    capvision::ui::MainWindow mainWindow(options);
     mainWindow.show();
     
     return app.exec();
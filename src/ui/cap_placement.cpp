@@ -0,0 +1,66 @@
+#include "../../include/ui/cap_placement.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace capvision {
+namespace ui {
+
+glm::mat4 capModelMatrix(const core::FaceDetector::FaceDetectionResult& face,
+                         int width, int height, const CapPlacement& placement) {
+    // Get face landmarks for positioning
+    cv::Point2f nose = face.landmarks[30];    // Nose tip
+    cv::Point2f leftEye = face.landmarks[36]; // Left eye outer corner
+    cv::Point2f rightEye = face.landmarks[45];// Right eye outer corner
+
+    // Convert screen coordinates to OpenGL coordinates (-1 to 1)
+    float screenX = (nose.x / width - 0.5f) * 2.0f;
+    float screenY = -(nose.y / height - 0.5f) * 2.0f;
+
+    // Calculate face width for scaling
+    float faceWidth = cv::norm(rightEye - leftEye);
+    float scale = faceWidth * placement.scale;
+
+    glm::mat4 modelMatrix(1.0f);
+
+    // Translation - use adjustments
+    modelMatrix = glm::translate(modelMatrix,
+        glm::vec3(screenX,
+                  screenY + placement.verticalOffset,
+                  placement.depthOffset));
+
+    // Apply face rotation
+    const cv::Matx33d& rotMat = face.rotation_matrix;
+    glm::mat4 rotationMatrix(
+        rotMat(0,0), rotMat(0,1), rotMat(0,2), 0.0f,
+        rotMat(1,0), rotMat(1,1), rotMat(1,2), 0.0f,
+        rotMat(2,0), rotMat(2,1), rotMat(2,2), 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    );
+    modelMatrix *= rotationMatrix;
+
+    // Apply scale
+    modelMatrix = glm::scale(modelMatrix, glm::vec3(scale));
+
+    // Apply additional rotation adjustments
+    modelMatrix = glm::rotate(modelMatrix,
+        glm::radians(placement.rotationOffset.x), glm::vec3(1.0f, 0.0f, 0.0f));
+    modelMatrix = glm::rotate(modelMatrix,
+        glm::radians(placement.rotationOffset.y), glm::vec3(0.0f, 1.0f, 0.0f));
+    modelMatrix = glm::rotate(modelMatrix,
+        glm::radians(placement.rotationOffset.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    return modelMatrix;
+}
+
+glm::mat4 capViewMatrix() {
+    return glm::lookAt(
+        glm::vec3(0.0f, 0.0f, 2.0f),
+        glm::vec3(0.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f)
+    );
+}
+
+glm::mat4 capProjectionMatrix(float aspectRatio) {
+    return glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 100.0f);
+}
+
+} // namespace ui
+} // namespace capvision
@@ -0,0 +1,135 @@
+#include "../../include/ui/cap_renderer.hpp"
+#include <iostream>
+
+namespace capvision {
+namespace ui {
+
+namespace {
+
+// One source pair for every variant; ShaderVariants adds TEXTURED and LIT.
+// Matrices are per-instance attributes, the normal matrix computed on the CPU.
+const char* const kVertexShaderSource = R"(#version 330 core
+    layout (location = 0) in vec3 aPos;
+    layout (location = 1) in vec3 aNormal;
+    layout (location = 2) in vec2 aTexCoord;
+    layout (location = 3) in mat4 aModel;
+    layout (location = 7) in mat3 aNormalMatrix;
+
+    out vec2 TexCoord;
+    out vec3 Normal;
+    out vec3 FragPos;
+
+    uniform mat4 view;
+    uniform mat4 projection;
+
+    void main() {
+        vec4 worldPos = aModel * vec4(aPos, 1.0);
+    #ifdef LIT
+        FragPos = worldPos.xyz;
+        Normal = aNormalMatrix * aNormal;
+    #endif
+    #ifdef TEXTURED
+        TexCoord = aTexCoord;
+    #endif
+        gl_Position = projection * view * worldPos;
+    }
+)";
+
+const char* const kFragmentShaderSource = R"(#version 330 core
+    out vec4 FragColor;
+
+    in vec2 TexCoord;
+    in vec3 Normal;
+    in vec3 FragPos;
+
+    uniform sampler2D texture_diffuse1;
+    uniform vec3 diffuseColor;
+    uniform vec3 lightPos;
+    uniform vec3 viewPos;
+
+    void main() {
+    #ifdef TEXTURED
+        vec4 texColor = texture(texture_diffuse1, TexCoord);
+
+        // Discard fully transparent pixels
+        if(texColor.a < 0.1)
+            discard;
+        vec3 color = texColor.rgb;
+    #else
+        vec3 color = diffuseColor;
+    #endif
+
+    #ifdef LIT
+        // Basic lighting: ambient + diffuse
+        vec3 norm = normalize(Normal);
+        vec3 lightDir = normalize(lightPos - FragPos);
+        float diff = max(dot(norm, lightDir), 0.0);
+        color *= vec3(0.3) + diff * vec3(1.0);
+    #endif
+
+        FragColor = vec4(color, 1.0); // Force opaque
+    }
+)";
+
+} // namespace
+
+CapRenderer::CapRenderer()
+    : shaders_(kVertexShaderSource, kFragmentShaderSource) {
+}
+
+bool CapRenderer::initialize() {
+    // Every variant up front, so the first frame a mesh needs one does not stall
+    if (!shaders_.compileAll()) {
+        std::cerr << "Failed to load model shaders" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool CapRenderer::loadModel(const std::string& path) {
+    auto model = std::make_unique<Model3D>(path.c_str());
+    if (model->empty()) {
+        return false;
+    }
+    models_.push_back(std::move(model));
+    return true;
+}
+
+void CapRenderer::unloadModel(size_t modelIndex) {
+    if (modelIndex >= models_.size()) return;
+
+    models_.erase(models_.begin() + modelIndex);
+    TextureCache::global().collect();
+}
+
+void CapRenderer::setupFrame(const glm::mat4& projection, const glm::mat4& view) {
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDepthFunc(GL_LESS);
+
+    ShaderVariants::FrameUniforms uniforms;
+    uniforms.projection = projection;
+    uniforms.view = view;
+    shaders_.beginFrame(uniforms);
+}
+
+void CapRenderer::render(size_t modelIndex, const std::vector<glm::mat4>& modelMatrices,
+                         const glm::mat4& projection, const glm::mat4& view, int lod) {
+    if (modelIndex >= models_.size() || modelMatrices.empty()) return;
+
+    setupFrame(projection, view);
+    models_[modelIndex]->render(shaders_, modelMatrices.data(), modelMatrices.size(), lod);
+}
+
+void CapRenderer::renderEach(size_t modelIndex, const std::vector<glm::mat4>& modelMatrices,
+                             const glm::mat4& projection, const glm::mat4& view, int lod) {
+    if (modelIndex >= models_.size() || modelMatrices.empty()) return;
+
+    setupFrame(projection, view);
+    for (const glm::mat4& modelMatrix : modelMatrices) {
+        models_[modelIndex]->render(shaders_, &modelMatrix, 1, lod);
+    }
+}
+
+} // namespace ui
+} // namespace capvision
@@ -1,7 +1,8 @@
 // src/ui/face_visualization.cpp
 #include "../../include/ui/face_visualizer.hpp"
-#include <sstream>
-#include <iomanip>
+#include <array>
+#include <cstdio>
+#include <string>
 
 namespace capvision {
 namespace ui {
@@ -30,7 +31,7 @@ void FaceVisualizer::drawFaceInfo(cv::Mat& frame,
 }
 
 void FaceVisualizer::drawLandmarks(cv::Mat& frame,
-                                     const std::vector<cv::Point2f>& landmarks,
+                                     const core::LandmarkArray& landmarks,
                                      const Options& options) {
     for (const auto& point : landmarks) {
         cv::circle(frame, point, options.landmarkRadius, 
@@ -39,7 +40,7 @@ void FaceVisualizer::drawLandmarks(cv::Mat& frame,
 }
 
 void FaceVisualizer::drawFaceConnections(cv::Mat& frame,
-                                           const std::vector<cv::Point2f>& landmarks,
+                                           const core::LandmarkArray& landmarks,
                                            const Options& options) {
     // Jaw line
     for (int i = 0; i < 16; i++) {
@@ -111,7 +112,7 @@ void FaceVisualizer::drawPoseAxes(cv::Mat& frame,
     float axisLength = 70.0f;
 
     // Define 3D axis points
-    std::vector<cv::Point3f> axisPoints = {
+    const std::array<cv::Point3f, 4> axisPoints = {
         cv::Point3f(0.0f, 0.0f, 0.0f),          // Origin
         cv::Point3f(axisLength, 0.0f, 0.0f),    // X: right
         cv::Point3f(0.0f, -axisLength, 0.0f),   // Y: up (negative because Y grows down in image)
@@ -119,19 +120,19 @@ void FaceVisualizer::drawPoseAxes(cv::Mat& frame,
     };
 
     // Get camera matrix based on image size
-    if (camera_matrix_.empty()) {
+    if (camera_matrix_(0, 0) == 0.0) {
         float focal_length = frame.cols;
-        camera_matrix_ = (cv::Mat_<double>(3, 3) <<
+        camera_matrix_ = cv::Matx33d(
             focal_length, 0, frame.cols/2,
             0, focal_length, frame.rows/2,
             0, 0, 1);
     }
 
     // Project points
-    std::vector<cv::Point2f> projectedPoints;
-    cv::Mat rvec;
+    std::array<cv::Point2f, 4> projectedPoints;
+    cv::Vec3d rvec;
     cv::Rodrigues(result.rotation_matrix, rvec);
-    cv::Mat tvec = (cv::Mat_<double>(3, 1) << 0, 0, 0);  // Translation at origin
+    const cv::Vec3d tvec(0, 0, 0);  // Translation at origin
 
     cv::projectPoints(axisPoints, rvec, tvec, camera_matrix_, dist_coeffs_, projectedPoints);
 
@@ -160,13 +161,13 @@ void FaceVisualizer::drawEulerAngles(cv::Mat& frame,
     double y_rot = euler_angles[1];
     double z_rot = euler_angles[2];
 
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(1)
-       << "X: " << x_rot << "° "
-       << "Y: " << y_rot << "° "
-       << "Z: " << z_rot << "°";
-    
-    cv::putText(frame, ss.str(), cv::Point(10, 30),
+    // Formatted on the stack into a reused string: no allocation per frame
+    char text[64];
+    std::snprintf(text, sizeof(text), "X: %.1f° Y: %.1f° Z: %.1f°", x_rot, y_rot, z_rot);
+    thread_local std::string label;
+    label.assign(text);
+
+    cv::putText(frame, label, cv::Point(10, 30),
                cv::FONT_HERSHEY_SIMPLEX, 0.7, options.connectionColor, 2);
 }
 
@@ -0,0 +1,221 @@
+#include "../../include/ui/frame_renderer.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace capvision {
+namespace ui {
+
+bool FrameRenderer::initialize(const std::string& capModelPath) {
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW" << std::endl;
+        return false;
+    }
+
+    // Enable depth testing
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    if (!videoShader_.loadFromString(videoVertexShaderSource_, videoFragmentShaderSource_)) {
+        std::cerr << "Failed to load video shaders" << std::endl;
+        return false;
+    }
+    if (!capRenderer_.initialize()) {
+        std::cerr << "Failed to load cap shaders" << std::endl;
+    }
+
+    // Setup quad for video rendering
+    setupQuad();
+
+    // Initialize textures
+    for (GLuint* texture : {&textureId_, &chromaTextureId_}) {
+        glGenTextures(1, texture);
+        glBindTexture(GL_TEXTURE_2D, *texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    view_ = capViewMatrix();
+    projection_ = capProjectionMatrix(width_ / static_cast<float>(height_));
+
+    std::cout << "Loading cap model..." << std::endl;
+    try {
+        if (capRenderer_.loadModel(capModelPath)) {
+            std::cout << "Model loaded successfully" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load model: " << e.what() << std::endl;
+    }
+    return true;
+}
+
+void FrameRenderer::release() {
+    gpuProfiler_.release();
+    if (textureId_) glDeleteTextures(1, &textureId_);
+    if (chromaTextureId_) glDeleteTextures(1, &chromaTextureId_);
+    if (quadVAO_) glDeleteVertexArrays(1, &quadVAO_);
+    if (quadVBO_) glDeleteBuffers(1, &quadVBO_);
+    if (quadEBO_) glDeleteBuffers(1, &quadEBO_);
+    textureId_ = chromaTextureId_ = 0;
+    quadVAO_ = quadVBO_ = quadEBO_ = 0;
+}
+
+void FrameRenderer::resize(int width, int height) {
+    width_ = std::max(width, 1);
+    height_ = std::max(height, 1);
+    glViewport(0, 0, width_, height_);
+
+    // Update projection matrix
+    projection_ = capProjectionMatrix(static_cast<float>(width_) / static_cast<float>(height_));
+    setFaces(faces_.data(), faces_.size());
+}
+
+void FrameRenderer::setFaces(const core::FaceDetector::FaceDetectionResult* faces, size_t count) {
+    if (faces != faces_.data()) {
+        faces_.assign(faces, faces + count);
+    }
+
+    // clear() keeps the capacity, so steady state does not allocate
+    capMatrices_.clear();
+    for (const auto& face : faces_) {
+        if (face.success && face.landmarks.size() > 45) {
+            capMatrices_.push_back(capModelMatrix(face, width_, height_, placement_));
+        }
+    }
+}
+
+bool FrameRenderer::setGpuProfiling(bool enabled) {
+    return gpuProfiler_.setEnabled(enabled);
+}
+
+void FrameRenderer::render(const cv::Mat* frame, bool yuv, size_t capIndex, int capLod) {
+    gpuProfiler_.beginFrame();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    if (frame && !frame->empty()) {
+        gpuProfiler_.beginPass("upload");
+        uploadFrame(*frame, yuv);
+        gpuProfiler_.endPass();
+    }
+
+    // Render video background
+    gpuProfiler_.beginPass("video");
+    renderVideo();
+    gpuProfiler_.endPass();
+
+    // One instanced draw per mesh for every face; matrices were built when
+    // the faces arrived
+    gpuProfiler_.beginPass("cap");
+    capRenderer_.render(capIndex, capMatrices_, projection_, view_, capLod);
+    gpuProfiler_.endPass();
+    gpuProfiler_.endFrame();
+}
+
+void FrameRenderer::renderVideo() {
+    glDisable(GL_DEPTH_TEST);  // Disable depth testing for video
+
+    videoShader_.use();
+    videoShader_.setInt("videoTexture", 0);
+    videoShader_.setInt("chromaTexture", 1);
+    videoShader_.setInt("yuvMode", textureYuv_ ? 1 : 0);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, chromaTextureId_);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, textureId_);
+
+    glBindVertexArray(quadVAO_);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+
+    glEnable(GL_DEPTH_TEST);  // Re-enable depth testing for 3D
+}
+
+void FrameRenderer::setupQuad() {
+    float vertices[] = {
+        // positions        // texture coords
+        -1.0f,  1.0f, 0.0f,  0.0f, 0.0f,  // top left
+         1.0f,  1.0f, 0.0f,  1.0f, 0.0f,  // top right
+         1.0f, -1.0f, 0.0f,  1.0f, 1.0f,  // bottom right
+        -1.0f, -1.0f, 0.0f,  0.0f, 1.0f   // bottom left
+    };
+
+    unsigned int indices[] = {
+        0, 1, 2,  // first triangle
+        0, 2, 3   // second triangle
+    };
+
+    glGenVertexArrays(1, &quadVAO_);
+    glGenBuffers(1, &quadVBO_);
+    glGenBuffers(1, &quadEBO_);
+
+    glBindVertexArray(quadVAO_);
+
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Texture coordinate attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void FrameRenderer::uploadFrame(const cv::Mat& frame, bool yuv) {
+    // Storage is only reallocated when the frame size or layout changes
+    const bool reallocate = frame.cols != textureWidth_ ||
+                            frame.rows != textureHeight_ ||
+                            yuv != textureYuv_;
+    textureWidth_ = frame.cols;
+    textureHeight_ = frame.rows;
+    textureYuv_ = yuv;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (!yuv) {
+        // GL swizzles BGR on upload; no CPU colour conversion
+        glBindTexture(GL_TEXTURE_2D, textureId_);
+        if (reallocate) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, textureWidth_, textureHeight_, 0,
+                         GL_BGR, GL_UNSIGNED_BYTE, frame.data);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidth_, textureHeight_,
+                            GL_BGR, GL_UNSIGNED_BYTE, frame.data);
+        }
+    } else {
+        // The same YUYV bytes feed two views: (Y, chroma) pairs per pixel for
+        // full-resolution luma, and (Y0, U, Y1, V) per macropixel for chroma
+        glBindTexture(GL_TEXTURE_2D, textureId_);
+        if (reallocate) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, textureWidth_, textureHeight_, 0,
+                         GL_RG, GL_UNSIGNED_BYTE, frame.data);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidth_, textureHeight_,
+                            GL_RG, GL_UNSIGNED_BYTE, frame.data);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, chromaTextureId_);
+        if (reallocate) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, textureWidth_ / 2, textureHeight_, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, frame.data);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidth_ / 2, textureHeight_,
+                            GL_RGBA, GL_UNSIGNED_BYTE, frame.data);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+} // namespace ui
+} // namespace capvision
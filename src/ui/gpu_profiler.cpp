@@ -0,0 +1,166 @@
+#include "../../include/ui/gpu_profiler.hpp"
+#include "../../include/core/instrumentation.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace capvision {
+namespace ui {
+
+void GpuProfiler::Pass::add(double ms) {
+    samples[next] = ms;
+    next = (next + 1) % kWindow;
+    count = std::min(count + 1, kWindow);
+}
+
+GpuProfiler::Stats GpuProfiler::Pass::stats() const {
+    Stats result;
+    result.samples = count;
+    for (size_t i = 0; i < count; ++i) {
+        result.mean_ms += samples[i];
+        result.max_ms = std::max(result.max_ms, samples[i]);
+    }
+    if (count > 0) {
+        result.mean_ms /= count;
+    }
+    return result;
+}
+
+bool GpuProfiler::setEnabled(bool enabled) {
+    if (enabled && !GLEW_ARB_timer_query && !GLEW_VERSION_3_3) {
+        enabled_ = false;
+        return false;
+    }
+    if (enabled && !created_) {
+        for (Frame& frame : frames_) {
+            glGenQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+        }
+        created_ = true;
+        total_.name = "frame";
+        total_.mean_key = "gpu.frame_ms";
+        total_.max_key = "gpu.frame_max_ms";
+    }
+    if (!enabled) {
+        // Results still in flight are abandoned
+        for (Frame& frame : frames_) {
+            frame.pending = false;
+        }
+        current_ = nullptr;
+        inPass_ = false;
+    }
+    enabled_ = enabled;
+    return true;
+}
+
+void GpuProfiler::release() {
+    if (created_) {
+        for (Frame& frame : frames_) {
+            glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+            frame.pending = false;
+        }
+        created_ = false;
+    }
+    enabled_ = false;
+    current_ = nullptr;
+}
+
+int GpuProfiler::passIndex(const char* name) {
+    for (size_t i = 0; i < passes_.size(); ++i) {
+        if (passes_[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    Pass pass;
+    pass.name = name;
+    pass.mean_key = "gpu." + pass.name + "_ms";
+    pass.max_key = "gpu." + pass.name + "_max_ms";
+    passes_.push_back(std::move(pass));
+    return static_cast<int>(passes_.size() - 1);
+}
+
+void GpuProfiler::collect(Frame& frame) {
+    frame.pending = false;
+    if (frame.used == 0) {
+        return;
+    }
+
+    // Queries complete in order: if the last is ready, all are
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[2 * frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        core::Instrumentation::global().add("gpu.dropped_frames");
+        return;
+    }
+
+    auto& instrumentation = core::Instrumentation::global();
+    GLuint64 first = 0, last = 0;
+    for (int p = 0; p < frame.used; ++p) {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[2 * p], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[2 * p + 1], GL_QUERY_RESULT, &end);
+        first = p == 0 ? begin : std::min(first, begin);
+        last = std::max(last, end);
+
+        Pass& pass = passes_[frame.pass[p]];
+        pass.add((end - begin) / 1e6);
+        const Stats s = pass.stats();
+        instrumentation.set(pass.mean_key, s.mean_ms);
+        instrumentation.set(pass.max_key, s.max_ms);
+    }
+    total_.add((last - first) / 1e6);
+    const Stats s = total_.stats();
+    instrumentation.set(total_.mean_key, s.mean_ms);
+    instrumentation.set(total_.max_key, s.max_ms);
+}
+
+void GpuProfiler::beginFrame() {
+    if (!enabled_) return;
+
+    // The slot issued kFramesInFlight frames ago is read, then reused
+    Frame& frame = frames_[frameNumber_++ % kFramesInFlight];
+    if (frame.pending) {
+        collect(frame);
+    }
+    frame.used = 0;
+    current_ = &frame;
+}
+
+void GpuProfiler::beginPass(const char* name) {
+    if (!enabled_ || !current_ || inPass_ || current_->used >= kMaxPasses) return;
+
+    current_->pass[current_->used] = passIndex(name);
+    glQueryCounter(current_->queries[2 * current_->used], GL_TIMESTAMP);
+    inPass_ = true;
+}
+
+void GpuProfiler::endPass() {
+    if (!enabled_ || !current_ || !inPass_) return;
+
+    glQueryCounter(current_->queries[2 * current_->used + 1], GL_TIMESTAMP);
+    ++current_->used;
+    inPass_ = false;
+}
+
+void GpuProfiler::endFrame() {
+    if (!enabled_ || !current_) return;
+
+    if (inPass_) {
+        endPass();
+    }
+    current_->pending = current_->used > 0;
+    current_ = nullptr;
+}
+
+GpuProfiler::Stats GpuProfiler::stats(const std::string& pass) const {
+    if (pass == total_.name) {
+        return total_.stats();
+    }
+    for (const Pass& p : passes_) {
+        if (p.name == pass) {
+            return p.stats();
+        }
+    }
+    return Stats{};
+}
+
+} // namespace ui
+} // namespace capvision
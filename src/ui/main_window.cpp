@@ -1,5 +1,9 @@
 #include "../../include/ui/main_window.hpp"
+#include "../../include/core/allocation_tracker.hpp"
+#include "../../include/core/instrumentation.hpp"
+#include <iostream>
 #include <QtCore/QTimer>
+#include <QtGui/QShortcut>
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QtWidgets>
 #include <QtWidgets/QLabel>
@@ -8,7 +12,13 @@ namespace capvision {
 namespace ui {
 
 MainWindow::MainWindow(QWidget *parent)
+    : MainWindow(Options{}, parent)
+{
+}
+
+MainWindow::MainWindow(const Options& options, QWidget *parent)
     : QMainWindow(parent)
+    , options_(options)
 {
     setupUi();
     initializeCamera();
@@ -26,8 +36,28 @@ void MainWindow::setupUi() {
     layout->setContentsMargins(0, 0, 0, 0);
     
     // Setup video widget
-     openglWidget_ = new OpenGLWidget(this);
-    layout->addWidget(openglWidget_);
+    if (options_.renderThread) {
+        auto renderWindow = new RenderWindow();
+        QWidget* container = QWidget::createWindowContainer(renderWindow, this);
+        if (renderWindow->start()) {
+            layout->addWidget(container);
+            videoView_ = renderWindow;
+        } else {
+            std::cerr << "Rendering on the GUI thread instead" << std::endl;
+            delete container;
+        }
+    }
+    if (!videoView_) {
+        auto openglWidget = new OpenGLWidget(this);
+        layout->addWidget(openglWidget);
+        videoView_ = openglWidget;
+    }
+    videoView_->setGpuProfiling(options_.gpuTimers);
+    auto gpuShortcut = new QShortcut(QKeySequence(Qt::Key_F3), this);
+    connect(gpuShortcut, &QShortcut::activated, this, [this]() {
+        videoView_->setGpuProfiling(!videoView_->gpuProfiling());
+        std::cout << "GPU timers " << (videoView_->gpuProfiling() ? "on" : "off") << std::endl;
+    });
     
     // Set default window size
     resize(800, 600);
@@ -39,9 +69,34 @@ void MainWindow::setupUi() {
 }
 
 void MainWindow::initializeCamera() {
+    // Replay needs neither a camera nor the detector
+    if (!options_.replayPath.empty()) {
+        if (replay_.open(options_.replayPath) && !options_.replayVideoPath.empty()) {
+            core::FileCaptureSource::Options videoOptions;
+            videoOptions.paced = false;
+            replayVideo_ = std::make_unique<core::FileCaptureSource>(options_.replayVideoPath, videoOptions);
+            replayVideo_->open();
+        }
+        replayStartUs_ = core::steadyNowMicros();
+        return;
+    }
+
     // Initialize camera
-    camera_.open(0);
-    if (!camera_.isOpened()) {
+#ifndef _WIN32
+    if (!options_.shmName.empty()) {
+        // Poll without blocking the UI; the producer may start later
+        core::ShmCaptureSource::Options shmOptions;
+        shmOptions.timeout_ms = 0;
+        auto source = std::make_unique<core::ShmCaptureSource>(options_.shmName, shmOptions);
+        shmSource_ = source.get();
+        shmSource_->open();
+        camera_ = std::move(source);
+    }
+#endif
+    if (!camera_) {
+        camera_ = core::createCameraSource(0);
+    }
+    if (!camera_->isOpened() && options_.shmName.empty()) {
         // TODO: Add error handling
         return;
     }
@@ -51,23 +106,263 @@ void MainWindow::initializeCamera() {
         // TODO: Add error handling
         exit(1);
     }
+    if (options_.warmLandmarks) {
+        core::FaceDetector::WarmStart warmStart;
+        warmStart.enabled = true;
+        faceDetector_.setLandmarkWarmStart(warmStart);
+    }
+    if (options_.trackFaces) {
+        faceTracker_.initialize(faceDetector_.models());
+    }
+    if (options_.predictPose) {
+        videoView_->setPosePredictor(&posePredictor_, options_.poseLeadMs);
+    }
+    if (options_.frameBudgetMs > 0.0) {
+        core::FrameScheduler::Config schedulerConfig;
+        schedulerConfig.budget_ms = options_.frameBudgetMs;
+        scheduler_ = std::make_unique<core::FrameScheduler>(schedulerConfig);
+        applySchedule();
+    }
 }
 
 void MainWindow::updateFrame() {
-    cv::Mat frame;
-    if (!camera_.read(frame)) {
+    if (replay_.isOpen()) {
+        updateReplay();
+        return;
+    }
+
+#ifndef _WIN32
+    if (shmSource_ && !shmSource_->isOpened()) {
+        shmSource_->open();
+    }
+#endif
+    int64_t stageStart = core::steadyNowMicros();
+    {
+        core::AllocationTracker::Scope allocations("capture");
+        if (!camera_ || !camera_->read(capturedFrame_)) {
+            return;
+        }
+    }
+
+    // YUV mode: no CPU colour conversion anywhere on the frame's path
+    if (options_.yuvPipeline && capturedFrame_.format == core::PixelFormat::YUYV) {
+        const double captureMs = (core::steadyNowMicros() - stageStart) / 1000.0;
+        if (options_.trackFaces) {
+            updateTracked(capturedFrame_.image, true, captureMs);
+            return;
+        }
+        core::FaceDetector::FaceDetectionResult result;
+        {
+            core::AllocationTracker::Scope allocations("detect");
+            result = detect(capturedFrame_.image);
+            shareResult(result);
+            trackPose(result);
+        }
+        {
+            core::AllocationTracker::Scope allocations("display");
+            videoView_->updateFrameYuyv(capturedFrame_.image, result);
+        }
+        scheduleFrame(captureMs, 0.0);
+        return;
+    }
+
+    // Overlays are drawn into frameBgr_, never into the driver's buffer
+    {
+        core::AllocationTracker::Scope allocations("capture");
+        if (!core::convertToBgr(capturedFrame_, frameBgr_)) {
+            return;
+        }
+    }
+    cv::Mat& frame = frameBgr_;
+    const double captureMs = (core::steadyNowMicros() - stageStart) / 1000.0;
+    if (options_.trackFaces) {
+        updateTracked(frame, false, captureMs);
         return;
     }
     
     // Detect face and get results
-    auto result = faceDetector_.detectFace(frame);
+    core::FaceDetector::FaceDetectionResult result;
+    {
+        core::AllocationTracker::Scope allocations("detect");
+        result = detect(frame);
+        shareResult(result);
+        trackPose(result);
+    }
+    stageStart = core::steadyNowMicros();
     if (result.success) {
         // Draw face information using FaceVisualizer
+        core::AllocationTracker::Scope allocations("overlay");
         FaceVisualizer::drawFaceInfo(frame, result, visualizerOptions_);
     }
     
     // Update display
-    openglWidget_->updateFrame(frame, result);
+    {
+        core::AllocationTracker::Scope allocations("display");
+        videoView_->updateFrame(frame, result);
+    }
+    scheduleFrame(captureMs, (core::steadyNowMicros() - stageStart) / 1000.0);
+}
+
+void MainWindow::scheduleFrame(double captureMs, double overlayMs) {
+    if (scheduler_) {
+        // Painting happens later, on the GUI or the render thread; the last
+        // paint stands in.
+        // A gated frame cost no detection at all.
+        const auto timings = detectionSkipped_ ? core::FaceDetector::StageTimings{}
+                                               : faceDetector_.lastTimings();
+        core::FrameScheduler::FrameCost cost;
+        cost.capture_ms = captureMs;
+        cost.detection_ms = timings.pyramid_ms + timings.detection_ms;
+        cost.landmarks_ms = timings.landmarks_ms;
+        cost.pose_ms = timings.pose_ms;
+        cost.render_ms = overlayMs + videoView_->lastPaintMs();
+        if (scheduler_->endFrame(cost)) {
+            applySchedule();
+        }
+    }
+
+    // Per-frame allocation counts (alloc.*); nothing unless built with
+    // CAPVISION_TRACK_ALLOCATIONS
+    core::AllocationTracker::publish();
+
+    if (options_.printStats) {
+        const int64_t now = core::steadyNowMicros();
+        if (now - statsPrintedUs_ >= 1000000) {
+            statsPrintedUs_ = now;
+            std::cout << core::Instrumentation::global().format() << std::endl;
+        }
+    }
+}
+
+void MainWindow::applySchedule() {
+    const auto& settings = scheduler_->settings();
+    faceDetector_.setLandmarkQuality(faceDetector_.landmarkQualityLevel(settings.landmark_quality));
+    faceDetector_.setDetectionInterval(settings.detection_interval);
+    faceDetector_.setDetectionFirstLevel(settings.detection_first_level);
+    videoView_->setCapLod(settings.cap_lod);
+}
+
+core::FaceDetector::FaceDetectionResult MainWindow::detect(const cv::Mat& frame) {
+    detectionSkipped_ = false;
+    if (!options_.motionGate) {
+        return faceDetector_.detectFace(frame);
+    }
+    if (!motionGate_.check(frame, capturedFrame_.timestamp_us)) {
+        detectionSkipped_ = true;
+        return lastResult_;
+    }
+    lastResult_ = faceDetector_.detectFace(frame);
+    motionGate_.update(lastResult_, capturedFrame_.timestamp_us);
+    return lastResult_;
+}
+
+void MainWindow::updateTracked(cv::Mat& frame, bool yuyv, double captureMs) {
+    const std::vector<core::FaceDetector::FaceDetectionResult>* faces = nullptr;
+    {
+        // Sharing, recording and pose prediction follow the oldest track
+        core::AllocationTracker::Scope allocations("detect");
+        faces = &faceTracker_.update(frame);
+        const core::FaceDetector::FaceDetectionResult primary =
+            faces->empty() ? core::FaceDetector::FaceDetectionResult{} : faces->front();
+        shareResult(primary);
+        trackPose(primary);
+    }
+    const int64_t stageStart = core::steadyNowMicros();
+    if (!yuyv) {
+        core::AllocationTracker::Scope allocations("overlay");
+        for (const auto& face : *faces) {
+            FaceVisualizer::drawFaceInfo(frame, face, visualizerOptions_);
+        }
+    }
+    {
+        core::AllocationTracker::Scope allocations("display");
+        if (yuyv) {
+            videoView_->updateFrameYuyv(frame, faces->data(), faces->size());
+        } else {
+            videoView_->updateFrame(frame, faces->data(), faces->size());
+        }
+    }
+    scheduleFrame(captureMs, (core::steadyNowMicros() - stageStart) / 1000.0);
+}
+
+void MainWindow::trackPose(const core::FaceDetector::FaceDetectionResult& result) {
+    videoView_->setFrameTime(capturedFrame_.timestamp_us);
+    if (options_.predictPose) {
+        posePredictor_.update(result, capturedFrame_.timestamp_us);
+    }
+}
+
+void MainWindow::shareResult(const core::FaceDetector::FaceDetectionResult& result) {
+#ifndef _WIN32
+    if (shmSource_) {
+        shmSource_->publishResult(capturedFrame_, result);
+    }
+#endif
+    if (!options_.recordPath.empty()) {
+        if (!recorder_.isOpen()) {
+            core::ResultRecorder::Options recordOptions;
+            recordOptions.frame_width = capturedFrame_.image.cols;
+            recordOptions.frame_height = capturedFrame_.image.rows;
+            if (!recorder_.open(options_.recordPath, recordOptions)) {
+                options_.recordPath.clear();
+                return;
+            }
+        }
+        recorder_.append(capturedFrame_.timestamp_us, result);
+    }
+}
+
+void MainWindow::updateReplay() {
+    // Show the newest recorded frame whose time has come, skipping any the
+    // UI was too slow for
+    const int64_t elapsed = core::steadyNowMicros() - replayStartUs_;
+    bool due = false;
+    while (true) {
+        if (!replayPending_) {
+            if (!replay_.next(replayNext_)) {
+                break;
+            }
+            replayPending_ = true;
+        }
+        if (replayNext_.timestamp_us - replay_.firstTimestampUs() > elapsed) {
+            break;
+        }
+        std::swap(replayShown_, replayNext_);
+        replayPending_ = false;
+        due = true;
+    }
+
+    if (!due) {
+        if (!replayPending_) {
+            // End of the recording: loop
+            replay_.seek(0);
+            replayStartUs_ = core::steadyNowMicros();
+            if (replayVideo_) {
+                replayVideo_->open();
+                replayVideoFrames_ = 0;
+            }
+        }
+        return;
+    }
+
+    // Background: the matching video frame, or a blank canvas of the recorded size
+    bool haveVideo = false;
+    while (replayVideo_ && replayVideoFrames_ <= replayShown_.index &&
+           replayVideo_->read(capturedFrame_)) {
+        ++replayVideoFrames_;
+        haveVideo = true;
+    }
+    if (!haveVideo || !core::convertToBgr(capturedFrame_, frameBgr_)) {
+        const int width = replay_.frameWidth() > 0 ? replay_.frameWidth() : 640;
+        const int height = replay_.frameHeight() > 0 ? replay_.frameHeight() : 480;
+        frameBgr_.create(height, width, CV_8UC3);
+        frameBgr_.setTo(cv::Scalar::all(0));
+    }
+
+    if (replayShown_.result.success) {
+        FaceVisualizer::drawFaceInfo(frameBgr_, replayShown_.result, visualizerOptions_);
+    }
+    videoView_->updateFrame(frameBgr_, replayShown_.result);
 }
 
 } // namespace ui
@@ -1,18 +1,44 @@
 #include "../../include/ui/mesh.hpp"
+#include <algorithm>
+#include <unordered_map>
 
 namespace capvision {
 namespace ui {
 
 Mesh::Mesh(const std::vector<Vertex>& vertices,
            const std::vector<unsigned int>& indices,
-           const std::vector<Texture>& textures)
+           const std::vector<Texture>& textures,
+           const glm::vec3& diffuseColor,
+           bool lit)
     : vertices(vertices)
     , indices(indices)
-    , textures(textures) {
+    , textures(textures)
+    , diffuseColor_(diffuseColor) {
+    if (lit) {
+        features_ |= ShaderVariants::kLit;
+    }
     setupMesh();
 }
 
 void Mesh::setupMesh() {
+    // Sampler uniform names, built once rather than on every draw
+    unsigned int diffuseNr = 1;
+    unsigned int specularNr = 1;
+    for (const Texture& texture : textures) {
+        // Retrieve texture number (the N in diffuse_textureN)
+        std::string number;
+        if (texture.type == "texture_diffuse")
+            number = std::to_string(diffuseNr++);
+        else if (texture.type == "texture_specular")
+            number = std::to_string(specularNr++);
+        samplerNames_.push_back(texture.type + number);
+
+        // Textures that failed to load have id 0 and draw as untextured
+        if (texture.type == "texture_diffuse" && texture.id != 0) {
+            features_ |= ShaderVariants::kTextured;
+        }
+    }
+
     // Generate buffers
     glGenVertexArrays(1, &VAO_);
     glGenBuffers(1, &VBO_);
@@ -26,10 +52,21 @@ void Mesh::setupMesh() {
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex),
                  &vertices[0], GL_STATIC_DRAW);
 
-    // Load index data
+    // Load index data: full mesh, then each coarser level after it
+    static const int kLodGrid[kLodCount] = {0, 48, 20};
+    std::vector<unsigned int> allIndices = indices;
+    lodOffset_[0] = 0;
+    lodCount_[0] = static_cast<unsigned int>(indices.size());
+    for (int lod = 1; lod < kLodCount; ++lod) {
+        std::vector<unsigned int> lodIndices = clusteredIndices(kLodGrid[lod]);
+        lodOffset_[lod] = static_cast<unsigned int>(allIndices.size());
+        lodCount_[lod] = static_cast<unsigned int>(lodIndices.size());
+        allIndices.insert(allIndices.end(), lodIndices.begin(), lodIndices.end());
+    }
+
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-                 &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, allIndices.size() * sizeof(unsigned int),
+                 allIndices.data(), GL_STATIC_DRAW);
 
     // Set vertex attribute pointers
     // Vertex positions
@@ -51,33 +88,89 @@ void Mesh::setupMesh() {
     glBindVertexArray(0);
 }
 
-void Mesh::render(Shader& shader) {
-    // Bind appropriate textures
-    unsigned int diffuseNr = 1;
-    unsigned int specularNr = 1;
+std::vector<unsigned int> Mesh::clusteredIndices(int gridSize) const {
+    if (vertices.empty()) {
+        return indices;
+    }
 
-    for(unsigned int i = 0; i < textures.size(); i++) {
-        // Activate proper texture unit before binding
-        glActiveTexture(GL_TEXTURE0 + i);
+    // Snap vertices to a gridSize^3 grid over the mesh bounds; each cell is
+    // drawn with its first vertex and triangles that collapse are dropped
+    glm::vec3 lo = vertices[0].position;
+    glm::vec3 hi = lo;
+    for (const Vertex& v : vertices) {
+        lo = glm::min(lo, v.position);
+        hi = glm::max(hi, v.position);
+    }
+    const glm::vec3 cell = glm::max((hi - lo) / static_cast<float>(gridSize), glm::vec3(1e-6f));
+
+    std::unordered_map<long long, unsigned int> representative;
+    std::vector<unsigned int> remap(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const glm::ivec3 c = glm::min(glm::ivec3((vertices[i].position - lo) / cell), glm::ivec3(gridSize - 1));
+        const long long key = (static_cast<long long>(c.x) * gridSize + c.y) * gridSize + c.z;
+        remap[i] = representative.emplace(key, static_cast<unsigned int>(i)).first->second;
+    }
 
-        // Retrieve texture number (the N in diffuse_textureN)
-        std::string number;
-        std::string name = textures[i].type;
-        if(name == "texture_diffuse")
-            number = std::to_string(diffuseNr++);
-        else if(name == "texture_specular")
-            number = std::to_string(specularNr++);
+    std::vector<unsigned int> lodIndices;
+    lodIndices.reserve(indices.size());
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        const unsigned int a = remap[indices[t]];
+        const unsigned int b = remap[indices[t + 1]];
+        const unsigned int c = remap[indices[t + 2]];
+        if (a != b && b != c && a != c) {
+            lodIndices.insert(lodIndices.end(), {a, b, c});
+        }
+    }
+    return lodIndices;
+}
+
+void Mesh::attachInstanceBuffer(GLuint buffer) {
+    glBindVertexArray(VAO_);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    // Matrix attributes take one location per column: the model matrix at
+    // 3-6, the normal matrix at 7-9
+    for (GLuint column = 0; column < 4; ++column) {
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              reinterpret_cast<void*>(offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    for (GLuint column = 0; column < 3; ++column) {
+        glEnableVertexAttribArray(7 + column);
+        glVertexAttribPointer(7 + column, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              reinterpret_cast<void*>(offsetof(InstanceData, normal) + column * sizeof(glm::vec3)));
+        glVertexAttribDivisor(7 + column, 1);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::render(ShaderVariants& shaders, int lod, int instances) {
+    Shader* shader = shaders.use(features_);
+    if (!shader) return;
+
+    if (features_ & ShaderVariants::kTextured) {
+        for(unsigned int i = 0; i < textures.size(); i++) {
+            // Activate proper texture unit before binding
+            glActiveTexture(GL_TEXTURE0 + i);
+
+            // Set the sampler to the correct texture unit
+            shader->setInt(samplerNames_[i].c_str(), i);
 
-        // Set the sampler to the correct texture unit
-        shader.setInt(("material." + name + number).c_str(), i);
-        
-        // Bind the texture
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+            // Bind the texture
+            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        }
+    } else {
+        shader->setVec3("diffuseColor", diffuseColor_.r, diffuseColor_.g, diffuseColor_.b);
     }
 
     // Draw mesh
     glBindVertexArray(VAO_);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    lod = std::max(0, std::min(lod, kLodCount - 1));
+    glDrawElementsInstanced(GL_TRIANGLES, lodCount_[lod], GL_UNSIGNED_INT,
+                            reinterpret_cast<void*>(lodOffset_[lod] * sizeof(unsigned int)), instances);
     glBindVertexArray(0);
 
     // Reset active texture
@@ -1,5 +1,5 @@
 #include "../../include/ui/model3d.hpp"
-#include <stb_image.h>
+#include <algorithm>
 #include <iostream>
 
 namespace capvision {
@@ -30,8 +30,22 @@ void Model3D::loadModel(const std::string& path) {
     // Store the directory path
     directory_ = path.substr(0, path.find_last_of('/'));
 
+    // Decode every texture of the model in parallel before building meshes
+    loadTextures(scene);
+
     // Process all the node's meshes recursively
     processNode(scene->mRootNode, scene);
+
+    // Draw meshes grouped by shader variant so programs switch least
+    std::stable_sort(meshes_.begin(), meshes_.end(), [](const Mesh& a, const Mesh& b) {
+        return a.features() < b.features();
+    });
+
+    // Every mesh reads its instance matrices from one shared buffer
+    glGenBuffers(1, &instanceBuffer_);
+    for (auto& mesh : meshes_) {
+        mesh.attachInstanceBuffer(instanceBuffer_);
+    }
 }
 
 void Model3D::processNode(aiNode* node, const aiScene* scene) {
@@ -88,9 +102,16 @@ Mesh Model3D::processMesh(aiMesh* mesh, const aiScene* scene) {
     }
 
     // Process material
+    glm::vec3 diffuseColor(1.0f);
     if(mesh->mMaterialIndex >= 0) {
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
+        // Colour for meshes drawn without a texture
+        aiColor4D color;
+        if (aiGetMaterialColor(material, AI_MATKEY_COLOR_DIFFUSE, &color) == AI_SUCCESS) {
+            diffuseColor = glm::vec3(color.r, color.g, color.b);
+        }
+
         // Load diffuse textures
         std::vector<Texture> diffuseMaps = loadMaterialTextures(
             material, aiTextureType_DIFFUSE, "texture_diffuse"
@@ -104,7 +125,32 @@ Mesh Model3D::processMesh(aiMesh* mesh, const aiScene* scene) {
         textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
     }
 
-    return Mesh(vertices, indices, textures);
+    return Mesh(vertices, indices, textures, diffuseColor, mesh->HasNormals());
+}
+
+void Model3D::loadTextures(const aiScene* scene) {
+    std::vector<std::string> names;
+    for (unsigned int m = 0; m < scene->mNumMaterials; m++) {
+        for (aiTextureType type : {aiTextureType_DIFFUSE, aiTextureType_SPECULAR}) {
+            for (unsigned int i = 0; i < scene->mMaterials[m]->GetTextureCount(type); i++) {
+                aiString str;
+                scene->mMaterials[m]->GetTexture(type, i, &str);
+                if (textures_.emplace(str.C_Str(), nullptr).second) {
+                    names.push_back(str.C_Str());
+                }
+            }
+        }
+    }
+
+    std::vector<std::string> paths;
+    paths.reserve(names.size());
+    for (const std::string& name : names) {
+        paths.push_back(directory_ + '/' + name);
+    }
+    std::vector<TextureCache::Handle> handles = TextureCache::global().acquire(paths);
+    for (size_t i = 0; i < names.size(); i++) {
+        textures_[names[i]] = std::move(handles[i]);
+    }
 }
 
 std::vector<Texture> Model3D::loadMaterialTextures(aiMaterial* mat, 
@@ -116,68 +162,39 @@ std::vector<Texture> Model3D::loadMaterialTextures(aiMaterial* mat,
         aiString str;
         mat->GetTexture(type, i, &str);
 
-        // Check if texture was loaded before
-        bool skip = false;
-        for(unsigned int j = 0; j < texturesLoaded_.size(); j++) {
-            if(std::strcmp(texturesLoaded_[j].path.data(), str.C_Str()) == 0) {
-                textures.push_back(texturesLoaded_[j]);
-                skip = true;
-                break;
-            }
-        }
-
-        if(!skip) {
-            Texture texture;
-            texture.id = textureFromFile(str.C_Str(), directory_);
-            texture.type = typeName;
-            texture.path = str.C_Str();
-            textures.push_back(texture);
-            texturesLoaded_.push_back(texture);
-        }
+        // Loaded up front by loadTextures; a file that failed binds no
+        // texture (id 0), as an empty texture did before
+        auto it = textures_.find(str.C_Str());
+        Texture texture;
+        texture.id = (it != textures_.end() && it->second) ? it->second->id : 0;
+        texture.type = typeName;
+        texture.path = str.C_Str();
+        textures.push_back(texture);
     }
 
     return textures;
 }
 
-unsigned int Model3D::textureFromFile(const char* path, const std::string& directory) {
-    std::string filename = std::string(path);
-    filename = directory + '/' + filename;
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data) {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    } else {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+void Model3D::render(ShaderVariants& shaders, const glm::mat4* modelMatrices, size_t count, int lod) {
+    if (count == 0 || !instanceBuffer_) return;
+
+    // Normal matrices once per instance here, not once per vertex on the GPU
+    instances_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        instances_[i].model = modelMatrices[i];
+        instances_[i].normal = glm::transpose(glm::inverse(glm::mat3(modelMatrices[i])));
     }
 
-    return textureID;
-}
+    // Orphan and refill the buffer so the upload does not wait on draws
+    // still reading the previous contents; its size never shrinks
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+    instanceCapacity_ = std::max(instanceCapacity_, count);
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity_ * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(InstanceData), instances_.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-void Model3D::render(Shader& shader) {
     for(unsigned int i = 0; i < meshes_.size(); i++) {
-        meshes_[i].render(shader);
+        meshes_[i].render(shaders, lod, static_cast<int>(count));
     }
 }
 
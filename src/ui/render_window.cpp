@@ -0,0 +1,188 @@
+#include "../../include/ui/render_window.hpp"
+#include <QtCore/QCoreApplication>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace capvision {
+namespace ui {
+
+namespace {
+
+// How long an idle render thread sleeps between looks at the handoff;
+// bounds the extra latency of a frame arriving while it sleeps
+constexpr auto kIdlePoll = std::chrono::milliseconds(1);
+
+} // namespace
+
+RenderWindow::RenderWindow(QWindow* parent)
+    : QWindow(parent)
+{
+    setSurfaceType(QWindow::OpenGLSurface);
+}
+
+RenderWindow::~RenderWindow() {
+    stop();
+}
+
+bool RenderWindow::start() {
+    if (thread_) {
+        return true;
+    }
+    if (!QOpenGLContext::supportsThreadedOpenGL()) {
+        std::cerr << "This platform cannot render OpenGL off the GUI thread" << std::endl;
+        return false;
+    }
+
+    create();
+    context_ = std::make_unique<QOpenGLContext>();
+    context_->setFormat(requestedFormat());
+    context_->setShareContext(QOpenGLContext::globalShareContext());
+    if (!context_->create()) {
+        std::cerr << "Failed to create the render thread's OpenGL context" << std::endl;
+        context_.reset();
+        return false;
+    }
+
+    storeSurfaceSize();
+    running_.store(true, std::memory_order_release);
+    thread_ = QThread::create([this]() { renderLoop(); });
+    thread_->setObjectName("capvision-render");
+    context_->moveToThread(thread_);
+    thread_->start();
+    return true;
+}
+
+void RenderWindow::stop() {
+    if (!thread_) {
+        return;
+    }
+    running_.store(false, std::memory_order_release);
+    thread_->wait();
+    delete thread_;
+    thread_ = nullptr;
+    context_.reset();
+}
+
+void RenderWindow::setPosePredictor(const core::PosePredictor* predictor, double leadMs) {
+    posePredictor_ = predictor;
+    poseLeadMs_ = leadMs;
+}
+
+void RenderWindow::setGpuProfiling(bool enabled) {
+    gpuProfilingRequested_.store(enabled, std::memory_order_relaxed);
+}
+
+void RenderWindow::updateFrame(const cv::Mat& frame,
+                               const core::FaceDetector::FaceDetectionResult* faces, size_t count)
+{
+    if (frame.empty()) return;
+    publish(frame, false, faces, count);
+}
+
+void RenderWindow::updateFrameYuyv(const cv::Mat& yuyv,
+                                   const core::FaceDetector::FaceDetectionResult* faces, size_t count)
+{
+    if (yuyv.empty() || yuyv.type() != CV_8UC2) return;
+    publish(yuyv, true, faces, count);
+}
+
+void RenderWindow::publish(const cv::Mat& frame, bool yuv,
+                           const core::FaceDetector::FaceDetectionResult* faces, size_t count) {
+    RenderFrame& slot = mailbox_.back();
+
+    // One copy into a reused buffer; the frame may belong to the capture driver
+    frame.copyTo(slot.image);
+    slot.yuv = yuv;
+
+    // Cap where the head is when this frame is seen, not where it was
+    // detected; the predictor is only read here, on the GUI thread
+    if (posePredictor_ && posePredictor_->hasFace()) {
+        const int64_t displayUs = frameCaptureUs_ + static_cast<int64_t>(poseLeadMs_ * 1000.0);
+        const auto predicted = posePredictor_->predict(displayUs);
+        slot.faces.clear();
+        if (predicted.landmarks.size() > 45) {
+            slot.faces.push_back(predicted);
+        }
+    } else {
+        slot.faces.assign(faces, faces + count);
+    }
+    mailbox_.publish();
+}
+
+void RenderWindow::exposeEvent(QExposeEvent*) {
+    storeSurfaceSize();
+    exposed_.store(isExposed(), std::memory_order_relaxed);
+}
+
+void RenderWindow::resizeEvent(QResizeEvent*) {
+    storeSurfaceSize();
+}
+
+void RenderWindow::storeSurfaceSize() {
+    const qreal ratio = devicePixelRatio();
+    surfaceWidth_.store(qRound(width() * ratio), std::memory_order_relaxed);
+    surfaceHeight_.store(qRound(height() * ratio), std::memory_order_relaxed);
+}
+
+void RenderWindow::renderLoop() {
+    if (!context_->makeCurrent(this) || !renderer_.initialize(FrameRenderer::kDefaultCapModel)) {
+        std::cerr << "Render thread could not set up OpenGL" << std::endl;
+        context_->doneCurrent();
+        context_->moveToThread(QCoreApplication::instance()->thread());
+        return;
+    }
+
+    int width = 0;
+    int height = 0;
+    bool redraw = false;
+    bool upload = false;
+    while (running_.load(std::memory_order_acquire)) {
+        const int surfaceWidth = surfaceWidth_.load(std::memory_order_relaxed);
+        const int surfaceHeight = surfaceHeight_.load(std::memory_order_relaxed);
+        if (surfaceWidth != width || surfaceHeight != height) {
+            width = surfaceWidth;
+            height = surfaceHeight;
+            renderer_.resize(width, height);
+            redraw = true;
+        }
+
+        const bool requested = gpuProfilingRequested_.load(std::memory_order_relaxed);
+        if (requested != renderer_.gpuProfiling() && !renderer_.setGpuProfiling(requested)) {
+            std::cerr << "GPU timer queries are not supported" << std::endl;
+            gpuProfilingRequested_.store(false, std::memory_order_relaxed);
+        }
+
+        // front() stays ours until the next consume(), so it is uploaded
+        // in place
+        if (mailbox_.consume()) {
+            const RenderFrame& frame = mailbox_.front();
+            renderer_.setFaces(frame.faces.data(), frame.faces.size());
+            redraw = upload = true;
+        }
+
+        if (!redraw || !exposed_.load(std::memory_order_relaxed) || width <= 0 || height <= 0) {
+            std::this_thread::sleep_for(kIdlePoll);
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const RenderFrame& frame = mailbox_.front();
+        renderer_.render(upload ? &frame.image : nullptr, frame.yuv, 0, capLod_.load(std::memory_order_relaxed));
+        lastPaintMs_.store(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+                           std::memory_order_relaxed);
+
+        // Waits for vsync here, on this thread only
+        context_->swapBuffers(this);
+        redraw = upload = false;
+    }
+
+    renderer_.release();
+    context_->doneCurrent();
+
+    // Hand the context back so the GUI thread can delete it
+    context_->moveToThread(QCoreApplication::instance()->thread());
+}
+
+} // namespace ui
+} // namespace capvision
@@ -67,21 +67,21 @@ bool Shader::compileShader(GLuint& shader, GLenum type, const std::string& sourc
     return true;
 }
 
-void Shader::setMat4(const std::string& name, const float* value) {
-    glUniformMatrix4fv(glGetUniformLocation(program_, name.c_str()), 
+void Shader::setMat4(const char* name, const float* value) {
+    glUniformMatrix4fv(glGetUniformLocation(program_, name), 
                       1, GL_FALSE, value);
 }
 
-void Shader::setVec3(const std::string& name, float x, float y, float z) {
-    glUniform3f(glGetUniformLocation(program_, name.c_str()), x, y, z);
+void Shader::setVec3(const char* name, float x, float y, float z) {
+    glUniform3f(glGetUniformLocation(program_, name), x, y, z);
 }
 
-void Shader::setFloat(const std::string& name, float value) {
-    glUniform1f(glGetUniformLocation(program_, name.c_str()), value);
+void Shader::setFloat(const char* name, float value) {
+    glUniform1f(glGetUniformLocation(program_, name), value);
 }
 
-void Shader::setInt(const std::string& name, int value) {
-    glUniform1i(glGetUniformLocation(program_, name.c_str()), value);
+void Shader::setInt(const char* name, int value) {
+    glUniform1i(glGetUniformLocation(program_, name), value);
 }
 
 } // namespace ui
@@ -0,0 +1,87 @@
+#include "../../include/ui/shader_variants.hpp"
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+
+namespace capvision {
+namespace ui {
+
+namespace {
+
+// Insert the defines after the #version line, which must stay first
+std::string specialise(const std::string& source, const std::string& defines) {
+    const size_t version = source.find("#version");
+    const size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+    if (lineEnd == std::string::npos) {
+        return defines + source;
+    }
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
+} // namespace
+
+ShaderVariants::ShaderVariants(std::string vertexSource, std::string fragmentSource)
+    : vertexSource_(std::move(vertexSource))
+    , fragmentSource_(std::move(fragmentSource)) {
+}
+
+std::string ShaderVariants::defines(unsigned int features) {
+    std::string result;
+    if (features & kTextured) result += "#define TEXTURED\n";
+    if (features & kLit) result += "#define LIT\n";
+    return result;
+}
+
+bool ShaderVariants::compileAll() {
+    bool ok = true;
+    for (unsigned int features = 0; features <= kAllFeatures; ++features) {
+        ok = variant(features).shader != nullptr && ok;
+    }
+    return ok;
+}
+
+ShaderVariants::Variant& ShaderVariants::variant(unsigned int features) {
+    Variant& v = variants_[features & kAllFeatures];
+    if (!v.shader && !v.failed) {
+        const std::string prelude = defines(features);
+        auto shader = std::make_unique<Shader>();
+        if (shader->loadFromString(specialise(vertexSource_, prelude), specialise(fragmentSource_, prelude))) {
+            v.shader = std::move(shader);
+        } else {
+            std::cerr << "Failed to compile shader variant:\n" << prelude << std::endl;
+            v.failed = true;
+        }
+    }
+    return v;
+}
+
+void ShaderVariants::beginFrame(const FrameUniforms& uniforms) {
+    uniforms_ = uniforms;
+    ++frame_;
+    bound_ = ~0u;   // Other programs may have been bound since the last frame
+}
+
+Shader* ShaderVariants::use(unsigned int features) {
+    features &= kAllFeatures;
+    Variant& v = variant(features);
+    if (!v.shader) {
+        return nullptr;
+    }
+
+    if (bound_ != features) {
+        v.shader->use();
+        bound_ = features;
+    }
+    if (v.frame != frame_) {
+        v.shader->setMat4("projection", glm::value_ptr(uniforms_.projection));
+        v.shader->setMat4("view", glm::value_ptr(uniforms_.view));
+        if (features & kLit) {
+            v.shader->setVec3("lightPos", uniforms_.lightPos.x, uniforms_.lightPos.y, uniforms_.lightPos.z);
+            v.shader->setVec3("viewPos", uniforms_.viewPos.x, uniforms_.viewPos.y, uniforms_.viewPos.z);
+        }
+        v.frame = frame_;
+    }
+    return v.shader.get();
+}
+
+} // namespace ui
+} // namespace capvision
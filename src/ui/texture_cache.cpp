@@ -0,0 +1,162 @@
+#include "../../include/ui/texture_cache.hpp"
+#include <stb_image.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace capvision {
+namespace ui {
+
+namespace {
+
+// FNV-1a over the file bytes
+uint64_t contentHash(const std::vector<unsigned char>& bytes) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char byte : bytes) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool readFile(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !bytes.empty();
+}
+
+struct Decoded {
+    uint64_t hash{0};
+    TextureCache::Handle cached;   // Already on the GPU; nothing decoded
+    unsigned char* pixels{nullptr};
+    int width{0};
+    int height{0};
+    int components{0};
+};
+
+} // namespace
+
+TextureCache& TextureCache::global() {
+    static TextureCache instance(std::make_shared<core::ThreadPool>(
+        std::max(1u, std::thread::hardware_concurrency() / 2)));
+    return instance;
+}
+
+TextureCache::TextureCache(std::shared_ptr<core::ThreadPool> pool)
+    : pool_(std::move(pool)) {
+}
+
+TextureCache::~TextureCache() = default;
+
+size_t TextureCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return textures_.size();
+}
+
+std::vector<TextureCache::Handle> TextureCache::acquire(const std::vector<std::string>& paths) {
+    collect();
+
+    // Read, hash and decode off the GL thread; files already cached are
+    // only read and hashed
+    std::vector<Decoded> decoded(paths.size());
+    auto decode = [&](size_t i) {
+        std::vector<unsigned char> bytes;
+        if (!readFile(paths[i], bytes)) {
+            return;
+        }
+        Decoded& out = decoded[i];
+        out.hash = contentHash(bytes);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = textures_.find(out.hash);
+            if (it != textures_.end()) {
+                out.cached = it->second.lock();
+            }
+        }
+        if (!out.cached) {
+            out.pixels = stbi_load_from_memory(bytes.data(), static_cast<int>(bytes.size()),
+                                               &out.width, &out.height, &out.components, 0);
+        }
+    };
+    if (pool_ && paths.size() > 1) {
+        pool_->parallelFor(paths.size(), decode);
+    } else {
+        for (size_t i = 0; i < paths.size(); ++i) {
+            decode(i);
+        }
+    }
+
+    // Upload on this thread; identical files in the same batch upload once
+    std::vector<Handle> handles(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        Decoded& in = decoded[i];
+        if (in.cached) {
+            handles[i] = std::move(in.cached);
+            continue;
+        }
+        if (!in.pixels) {
+            std::cout << "Texture failed to load at path: " << paths[i] << std::endl;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = textures_[in.hash];
+        handles[i] = slot.lock();
+        if (!handles[i]) {
+            GLenum format = GL_RGBA;
+            if (in.components == 1)
+                format = GL_RED;
+            else if (in.components == 3)
+                format = GL_RGB;
+
+            auto* texture = new CachedTexture{0, in.width, in.height, in.hash};
+            glGenTextures(1, &texture->id);
+            glBindTexture(GL_TEXTURE_2D, texture->id);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, format, in.width, in.height, 0, format, GL_UNSIGNED_BYTE, in.pixels);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glGenerateMipmap(GL_TEXTURE_2D);
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            handles[i] = Handle(texture, [this](const CachedTexture* t) { release(t); });
+            slot = handles[i];
+        }
+        stbi_image_free(in.pixels);
+        in.pixels = nullptr;
+    }
+    return handles;
+}
+
+void TextureCache::release(const CachedTexture* texture) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // The slot may already hold a newer upload of the same content
+        auto it = textures_.find(texture->hash);
+        if (it != textures_.end() && it->second.expired()) {
+            textures_.erase(it);
+        }
+        released_.push_back(texture->id);
+    }
+    delete texture;
+}
+
+void TextureCache::collect() {
+    std::vector<GLuint> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released.swap(released_);
+    }
+    if (!released.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(released.size()), released.data());
+    }
+}
+
+} // namespace ui
+} // namespace capvision
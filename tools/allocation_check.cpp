@@ -0,0 +1,162 @@
+// Steady-state heap allocation check of the frame loop.
+//
+// usage: allocation_check [--frames N] [--warmup N] [--max-per-frame F]
+//                         [--detection-interval K] [--threads N] source
+//   source: a video file, an image directory or an image pattern, looped.
+//   Runs the app's per-frame path headless (capture and BGR conversion,
+//   detectFace, FaceVisualizer::drawFaceInfo with every overlay on) for
+//   --warmup frames, then counts the allocations of each stage over
+//   --frames more. Exits 1 when the frames allocate more than
+//   --max-per-frame times on average (default 0), 2 on a setup error or
+//   when the build lacks CAPVISION_TRACK_ALLOCATIONS.
+//
+// The detector runs serially by default: pool workers have no stage, so
+// with --threads their allocations are reported under "other".
+#include "../include/core/allocation_tracker.hpp"
+#include "../include/core/file_capture_source.hpp"
+#include "../include/ui/face_visualizer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace capvision::core;
+using capvision::ui::FaceVisualizer;
+
+namespace {
+
+// This tool's own bookkeeping, left out of the report
+constexpr const char* kCheckStage = "check";
+
+struct Loop {
+    FileCaptureSource& capture;
+    FaceDetector& detector;
+    FaceVisualizer::Options overlay;
+    CapturedFrame frame;
+    cv::Mat bgr;
+
+    bool step() {
+        {
+            AllocationTracker::Scope allocations("capture");
+            if (!capture.read(frame) || !convertToBgr(frame, bgr)) {
+                return false;
+            }
+        }
+        FaceDetector::FaceDetectionResult result;
+        {
+            AllocationTracker::Scope allocations("detect");
+            result = detector.detectFace(bgr);
+        }
+        if (result.success) {
+            AllocationTracker::Scope allocations("overlay");
+            FaceVisualizer::drawFaceInfo(bgr, result, overlay);
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t frames = 200;
+    size_t warmup = 30;
+    double max_per_frame = 0.0;
+    int detection_interval = 1;
+    size_t threads = 1;
+    std::string source;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--max-per-frame") == 0 && i + 1 < argc) {
+            max_per_frame = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--detection-interval") == 0 && i + 1 < argc) {
+            detection_interval = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            source = argv[i];
+        }
+    }
+
+    if (source.empty()) {
+        std::cerr << "usage: allocation_check [--frames N] [--warmup N] [--max-per-frame F] "
+                     "[--detection-interval K] [--threads N] source" << std::endl;
+        return 2;
+    }
+    if (!AllocationTracker::kEnabled) {
+        std::cerr << "Built without CAPVISION_TRACK_ALLOCATIONS; reconfigure with "
+                     "-DCAPVISION_TRACK_ALLOCATIONS=ON" << std::endl;
+        return 2;
+    }
+
+    FaceDetector detector;
+    if (!detector.initialize()) {
+        return 2;
+    }
+    detector.setDetectionPool(threads > 1 ? std::make_shared<ThreadPool>(threads - 1) : nullptr);
+    detector.setDetectionInterval(detection_interval);
+
+    FileCaptureSource::Options options;
+    options.loop = true;
+    FileCaptureSource capture(source, options);
+    if (!capture.open()) {
+        std::cerr << "Failed to open " << source << std::endl;
+        return 2;
+    }
+
+    Loop loop{capture, detector, FaceVisualizer::Options{}, CapturedFrame{}, cv::Mat{}};
+    loop.overlay.showPoseAxes = true;
+    loop.overlay.showEulerAngles = true;
+
+    for (size_t f = 0; f < warmup; ++f) {
+        if (!loop.step()) {
+            std::cerr << "Failed to read frame " << f << std::endl;
+            return 2;
+        }
+    }
+
+    std::map<std::string, AllocationTracker::Counts> before;
+    {
+        AllocationTracker::Scope bookkeeping(kCheckStage);
+        for (const auto& [stage, counts] : AllocationTracker::snapshot()) {
+            before[stage] = counts;
+        }
+    }
+    for (size_t f = 0; f < frames; ++f) {
+        if (!loop.step()) {
+            std::cerr << "Failed to read frame " << warmup + f << std::endl;
+            return 2;
+        }
+    }
+    AllocationTracker::Scope bookkeeping(kCheckStage);
+    const auto after = AllocationTracker::snapshot();
+
+    std::cout << frames << " frames after " << warmup << " warm-up, detection on 1 in "
+              << detection_interval << std::endl
+              << std::left << std::setw(12) << "stage" << std::right
+              << std::setw(16) << "allocs/frame" << std::setw(16) << "bytes/frame" << std::endl;
+    double total = 0.0;
+    for (const auto& [stage, counts] : after) {
+        if (stage == kCheckStage) {
+            continue;
+        }
+        const AllocationTracker::Counts& start = before[stage];
+        const double allocations = static_cast<double>(counts.allocations - start.allocations) / frames;
+        const double bytes = static_cast<double>(counts.bytes - start.bytes) / frames;
+        total += allocations;
+        std::cout << std::left << std::setw(12) << stage << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(16) << allocations << std::setw(16) << bytes << std::endl;
+    }
+
+    const bool pass = total <= max_per_frame;
+    std::cout << "total " << total << " allocations per frame, limit " << max_per_frame
+              << (pass ? ": PASS" : ": FAIL") << std::endl;
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,423 @@
+// Composites of customer photos wearing every cap in the catalog.
+//
+// usage: batch_tryon [--caps DIR] [--cap model.obj]... [--out DIR]
+//                    [--threads N] [--batch N] [--ext jpg|png] photo|dir...
+//   Caps are the --cap models, or every .obj under --caps (default
+//   resources/models/caps). Photos are image files or directories of them.
+//   Writes <out>/<photo>_<cap>.<ext> (default out/ and jpg) for every photo
+//   with a face, placing the cap exactly as the app does.
+//
+// Photos are detected once each, in batches, on --threads detectors sharing
+// one copy of the models. Every cap model is loaded once and stays resident
+// on the GPU for the whole run. Each photo's caps are drawn offscreen over a
+// transparent background, and read back through two alternating pixel
+// buffers so the next draw overlaps the transfer. The worker threads
+// composite each cap over its photo and encode the files. Reports
+// composites per second.
+#include "../include/core/face_detector.hpp"
+#include "../include/core/thread_pool.hpp"
+#include "../include/ui/cap_placement.hpp"
+#include "../include/ui/cap_renderer.hpp"
+#include <QtGui/QGuiApplication>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace capvision::core;
+using namespace capvision::ui;
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string lowerExtension(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+bool isImage(const fs::path& path) {
+    const std::string ext = lowerExtension(path);
+    return ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp";
+}
+
+// Files named directly, then the images of each directory in name order
+std::vector<fs::path> collect(const std::vector<std::string>& inputs, bool (*accept)(const fs::path&),
+                              bool recursive) {
+    std::vector<fs::path> paths;
+    for (const std::string& input : inputs) {
+        if (!fs::is_directory(input)) {
+            paths.emplace_back(input);
+            continue;
+        }
+        std::vector<fs::path> found;
+        if (recursive) {
+            for (const auto& entry : fs::recursive_directory_iterator(input)) {
+                if (entry.is_regular_file() && accept(entry.path())) found.push_back(entry.path());
+            }
+        } else {
+            for (const auto& entry : fs::directory_iterator(input)) {
+                if (entry.is_regular_file() && accept(entry.path())) found.push_back(entry.path());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        paths.insert(paths.end(), found.begin(), found.end());
+    }
+    return paths;
+}
+
+struct Photo {
+    fs::path path;
+    cv::Mat image;   // BGR
+    FaceDetector::FaceDetectionResult face;
+};
+
+// Photo pixels under the cap's, by the cap's alpha; the cap image is
+// bottom-up BGRA as glReadPixels returns it
+void composite(const cv::Mat& photo, const cv::Mat& cap, cv::Mat& out) {
+    out.create(photo.size(), CV_8UC3);
+    for (int y = 0; y < photo.rows; ++y) {
+        const uchar* p = photo.ptr<uchar>(y);
+        const uchar* c = cap.ptr<uchar>(photo.rows - 1 - y);
+        uchar* o = out.ptr<uchar>(y);
+        for (int x = 0; x < photo.cols; ++x, p += 3, c += 4, o += 3) {
+            const int a = c[3];
+            for (int k = 0; k < 3; ++k) {
+                o[k] = static_cast<uchar>((p[k] * (255 - a) + c[k] * a + 127) / 255);
+            }
+        }
+    }
+}
+
+// Offscreen colour + depth target, resized to each photo
+class Target {
+public:
+    Target() {
+        glGenFramebuffers(1, &fbo_);
+        glGenRenderbuffers(1, &color_);
+        glGenRenderbuffers(1, &depth_);
+    }
+
+    ~Target() {
+        glDeleteRenderbuffers(1, &depth_);
+        glDeleteRenderbuffers(1, &color_);
+        glDeleteFramebuffers(1, &fbo_);
+    }
+
+    bool bind(cv::Size size) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+        if (size != size_) {
+            glBindRenderbuffer(GL_RENDERBUFFER, color_);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.width, size.height);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_);
+            glBindRenderbuffer(GL_RENDERBUFFER, depth_);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.width, size.height);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_);
+            size_ = size;
+        }
+        glViewport(0, 0, size.width, size.height);
+        return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+
+private:
+    GLuint fbo_{0}, color_{0}, depth_{0};
+    cv::Size size_;
+};
+
+// Two pixel-pack buffers: the read of one draw is queued while the
+// previous draw's pixels are copied out of the other
+class Readback {
+public:
+    struct Done {
+        std::shared_ptr<const Photo> photo;
+        size_t cap{0};
+        cv::Mat pixels;   // Bottom-up BGRA
+    };
+
+    Readback() { glGenBuffers(static_cast<GLsizei>(buffers_.size()), buffers_.data()); }
+    ~Readback() { glDeleteBuffers(static_cast<GLsizei>(buffers_.size()), buffers_.data()); }
+
+    // Queue a read of the bound framebuffer; returns the previous one, if any
+    bool push(std::shared_ptr<const Photo> photo, size_t cap, Done& done) {
+        const int slot = next_;
+        next_ = 1 - next_;
+        Pending& pending = pending_[slot];
+        const cv::Size size = photo->image.size();
+        const size_t bytes = static_cast<size_t>(size.width) * size.height * 4;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[slot]);
+        if (bytes != pending.bytes) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+            pending.bytes = bytes;
+        }
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, size.width, size.height, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pending.photo = std::move(photo);
+        pending.cap = cap;
+        return pop(next_, done);
+    }
+
+    // The read still outstanding after the last push
+    bool flush(Done& done) {
+        next_ = 1 - next_;
+        return pop(next_, done);
+    }
+
+private:
+    struct Pending {
+        std::shared_ptr<const Photo> photo;
+        size_t cap{0};
+        size_t bytes{0};
+    };
+
+    bool pop(int slot, Done& done) {
+        Pending& pending = pending_[slot];
+        if (!pending.photo) {
+            return false;
+        }
+        const cv::Size size = pending.photo->image.size();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers_[slot]);
+        const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pending.bytes, GL_MAP_READ_BIT);
+        done.pixels = cv::Mat(size, CV_8UC4);
+        if (data) {
+            std::memcpy(done.pixels.data, data, pending.bytes);
+        } else {
+            done.pixels.setTo(cv::Scalar::all(0));
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        done.photo = std::move(pending.photo);
+        done.cap = pending.cap;
+        return true;
+    }
+
+    std::array<GLuint, 2> buffers_{};
+    std::array<Pending, 2> pending_;
+    int next_{0};
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string caps_dir = "resources/models/caps";
+    std::vector<std::string> cap_args;
+    fs::path out_dir = "out";
+    size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    size_t batch_size = 0;
+    std::string ext = "jpg";
+    std::vector<std::string> photo_args;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--caps") == 0 && i + 1 < argc) {
+            caps_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--cap") == 0 && i + 1 < argc) {
+            cap_args.push_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            thread_count = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_size = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--ext") == 0 && i + 1 < argc) {
+            ext = argv[++i];
+        } else {
+            photo_args.push_back(argv[i]);
+        }
+    }
+    if (batch_size == 0) {
+        batch_size = 2 * thread_count;
+    }
+
+    const std::vector<fs::path> photos = collect(photo_args, isImage, false);
+    const std::vector<fs::path> caps = collect(cap_args.empty() ? std::vector<std::string>{caps_dir} : cap_args,
+                                               [](const fs::path& p) { return lowerExtension(p) == ".obj"; }, true);
+    if (photos.empty() || caps.empty()) {
+        std::cerr << "usage: batch_tryon [--caps DIR] [--cap model.obj]... [--out DIR] "
+                     "[--threads N] [--batch N] [--ext jpg|png] photo|dir..." << std::endl;
+        return 1;
+    }
+    std::error_code error;
+    fs::create_directories(out_dir, error);
+    if (error) {
+        std::cerr << "Failed to create " << out_dir << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    // Headless: Qt only provides the GL context
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        std::cerr << "Failed to create an OpenGL 3.3 context" << std::endl;
+        return 1;
+    }
+
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW" << std::endl;
+        return 1;
+    }
+    glGetError(); // glewInit leaves GL_INVALID_ENUM on core profiles
+
+    // Every cap stays loaded for the whole run
+    const auto load_start = Clock::now();
+    CapRenderer renderer;
+    if (!renderer.initialize()) {
+        return 1;
+    }
+    std::vector<std::string> cap_names;
+    for (const fs::path& cap : caps) {
+        if (!renderer.loadModel(cap.string())) {
+            std::cerr << "Failed to load " << cap << std::endl;
+            return 1;
+        }
+        cap_names.push_back(cap.stem().string());
+    }
+    const double load_s = secondsSince(load_start);
+
+    // One detector per lane, all on the same models
+    std::vector<std::unique_ptr<FaceDetector>> detectors;
+    for (size_t t = 0; t < thread_count; ++t) {
+        auto detector = std::make_unique<FaceDetector>();
+        detector->setDetectionPool(nullptr);
+        const bool ok = t == 0 ? detector->initialize() : detector->initialize(detectors[0]->models());
+        if (!ok) {
+            return 1;
+        }
+        detectors.push_back(std::move(detector));
+    }
+    ThreadPool pool(thread_count);
+
+    Target target;
+    Readback readback;
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);   // Alpha 0 where no cap is drawn
+    const glm::mat4 view = capViewMatrix();
+
+    std::deque<std::future<bool>> writes;
+    std::atomic<size_t> failed_writes{0};
+    auto write = [&](Readback::Done done) {
+        // Keep the number of images held in memory bounded
+        while (writes.size() >= 4 * thread_count) {
+            writes.front().wait();
+            writes.pop_front();
+        }
+        const fs::path path = out_dir / (done.photo->path.stem().string() + "_" + cap_names[done.cap] + "." + ext);
+        writes.push_back(pool.submit([done = std::move(done), path, &failed_writes]() {
+            cv::Mat out;
+            composite(done.photo->image, done.pixels, out);
+            if (!cv::imwrite(path.string(), out)) {
+                ++failed_writes;
+                return false;
+            }
+            return true;
+        }));
+    };
+
+    size_t faces = 0;
+    size_t composites = 0;
+    double detect_s = 0.0;
+    double render_s = 0.0;
+    const auto run_start = Clock::now();
+
+    for (size_t first = 0; first < photos.size(); first += batch_size) {
+        const size_t count = std::min(batch_size, photos.size() - first);
+
+        // Detect the batch, lane t taking photos t, t + lanes, ...
+        auto stage_start = Clock::now();
+        std::vector<std::shared_ptr<Photo>> batch(count);
+        const size_t lanes = std::min(count, detectors.size());
+        pool.parallelFor(lanes, [&](size_t lane) {
+            for (size_t i = lane; i < count; i += lanes) {
+                auto photo = std::make_shared<Photo>();
+                photo->path = photos[first + i];
+                photo->image = cv::imread(photo->path.string(), cv::IMREAD_COLOR);
+                if (!photo->image.empty()) {
+                    photo->face = detectors[lane]->detectFace(photo->image);
+                }
+                batch[i] = std::move(photo);
+            }
+        });
+        detect_s += secondsSince(stage_start);
+
+        // Draw every cap on each photo with a face
+        stage_start = Clock::now();
+        for (auto& photo : batch) {
+            if (photo->image.empty()) {
+                std::cerr << "Failed to read " << photo->path << std::endl;
+                continue;
+            }
+            if (!photo->face.success || photo->face.landmarks.size() <= 45) {
+                std::cerr << "No face in " << photo->path << std::endl;
+                continue;
+            }
+            ++faces;
+            const cv::Size size = photo->image.size();
+            if (!target.bind(size)) {
+                std::cerr << "Offscreen framebuffer is incomplete for " << photo->path << std::endl;
+                continue;
+            }
+            const std::vector<glm::mat4> matrices{capModelMatrix(photo->face, size.width, size.height)};
+            const glm::mat4 projection = capProjectionMatrix(static_cast<float>(size.width) / size.height);
+            std::shared_ptr<const Photo> shared = photo;
+            for (size_t cap = 0; cap < renderer.modelCount(); ++cap) {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                renderer.render(cap, matrices, projection, view);
+                Readback::Done done;
+                if (readback.push(shared, cap, done)) {
+                    write(std::move(done));
+                }
+                ++composites;
+            }
+        }
+        render_s += secondsSince(stage_start);
+    }
+    Readback::Done done;
+    if (readback.flush(done)) {
+        write(std::move(done));
+    }
+    for (auto& pending : writes) {
+        pending.wait();
+    }
+    const double total_s = secondsSince(run_start);
+
+    std::cout << photos.size() << " photos (" << faces << " with a face) x " << caps.size() << " caps = "
+              << composites << " composites on " << thread_count << " threads" << std::endl
+              << std::fixed << std::setprecision(2)
+              << "load " << load_s << " s, detect " << detect_s << " s, render " << render_s
+              << " s, total " << total_s << " s" << std::endl
+              << "throughput " << (total_s > 0.0 ? composites / total_s : 0.0) << " composites/s" << std::endl;
+    if (failed_writes > 0) {
+        std::cerr << failed_writes << " images could not be written" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,149 @@
+// Cap draw cost for 1 to 32 faces, instanced against one draw per face.
+//
+// usage: cap_render_bench [--frames N] [--lod L] [model.obj]
+//   Renders offscreen into a 1280x720 framebuffer; no window or display is
+//   needed. Faces are laid out on a grid in front of the camera. Each frame
+//   is finished with glFinish, so the times include GPU work.
+#include "../include/ui/cap_renderer.hpp"
+#include <QtGui/QGuiApplication>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace capvision::ui;
+
+namespace {
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+
+// count caps on a square grid filling the view, at the widget's usual depth
+std::vector<glm::mat4> gridMatrices(int count) {
+    const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    std::vector<glm::mat4> matrices;
+    for (int i = 0; i < count; ++i) {
+        const float x = ((i % side) + 0.5f) / side * 2.0f - 1.0f;
+        const float y = ((i / side) + 0.5f) / side * 2.0f - 1.0f;
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x * 2.0f, y * 1.2f, -3.0f));
+        model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        model = glm::scale(model, glm::vec3(0.08f / side));
+        matrices.push_back(model);
+    }
+    return matrices;
+}
+
+template <typename Draw>
+double timeFrames(int frames, Draw draw) {
+    // One untimed frame so buffer growth and driver warm-up are not counted
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    draw();
+    glFinish();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        draw();
+        glFinish();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int frames = 200;
+    int lod = 0;
+    std::string model_path = "resources/models/caps/10131_BaseballCap_v2_L3.obj";
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--lod") == 0 && i + 1 < argc) {
+            lod = std::atoi(argv[++i]);
+        } else {
+            model_path = argv[i];
+        }
+    }
+
+    // Headless: Qt only provides the GL context
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        std::cerr << "Failed to create an OpenGL 3.3 context" << std::endl;
+        return 1;
+    }
+
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW" << std::endl;
+        return 1;
+    }
+    glGetError(); // glewInit leaves GL_INVALID_ENUM on core profiles
+
+    GLuint fbo = 0, color = 0, depth = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, kWidth, kHeight);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, kWidth, kHeight);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        return 1;
+    }
+    glViewport(0, 0, kWidth, kHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    CapRenderer renderer;
+    if (!renderer.initialize() || !renderer.loadModel(model_path)) {
+        std::cerr << "Failed to load " << model_path << std::endl;
+        return 1;
+    }
+
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f),
+                                                  static_cast<float>(kWidth) / kHeight, 0.1f, 100.0f);
+
+    std::cout << std::left << std::setw(8) << "faces" << std::right
+              << std::setw(14) << "each ms" << std::setw(14) << "instanced ms" << std::setw(10) << "speedup" << std::endl;
+    for (int faces : {1, 2, 4, 8, 16, 32}) {
+        const std::vector<glm::mat4> matrices = gridMatrices(faces);
+        const double each_ms = timeFrames(frames, [&] {
+            renderer.renderEach(0, matrices, projection, view, lod);
+        });
+        const double instanced_ms = timeFrames(frames, [&] {
+            renderer.render(0, matrices, projection, view, lod);
+        });
+        std::cout << std::left << std::setw(8) << faces << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(14) << each_ms << std::setw(14) << instanced_ms
+                  << std::setw(9) << std::setprecision(2) << (instanced_ms > 0.0 ? each_ms / instanced_ms : 0.0)
+                  << "x" << std::endl;
+    }
+
+    glDeleteRenderbuffers(1, &depth);
+    glDeleteRenderbuffers(1, &color);
+    glDeleteFramebuffers(1, &fbo);
+    return 0;
+}
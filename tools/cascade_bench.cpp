@@ -0,0 +1,151 @@
+// Landmark latency versus accuracy for each shape-predictor cascade setting.
+//
+// usage: cascade_bench [--frames N] source
+//   source: a video file, an image directory or an image pattern.
+//   Landmarks from the full cascade are the reference; every cascade depth
+//   and quality preset is then timed and its error measured against them,
+//   followed by warm starts from the previous frame at several start levels
+//   (only meaningful when the frames are consecutive video).
+#include "../include/core/file_capture_source.hpp"
+#include "../include/core/face_detector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace capvision::core;
+
+namespace {
+
+struct Row {
+    std::string name;
+    FaceDetector::LandmarkQuality quality;
+};
+
+void runRow(FaceDetector& detector, const Row& row, const std::vector<cv::Mat>& frames,
+            const std::vector<LandmarkArray>& reference) {
+    double time_ms = 0.0;
+    double error_sum = 0.0;
+    double error_max = 0.0;
+    size_t faces = 0;
+    size_t points = 0;
+
+    for (size_t f = 0; f < frames.size(); ++f) {
+        if (reference[f].empty()) {
+            continue;
+        }
+        const auto result = detector.detectFace(frames[f], row.quality);
+        if (!result.success) {
+            continue;
+        }
+        time_ms += detector.lastTimings().landmarks_ms;
+        ++faces;
+        for (size_t i = 0; i < result.landmarks.size(); ++i) {
+            const cv::Point2f delta = result.landmarks[i] - reference[f][i];
+            const double error = std::sqrt(delta.dot(delta));
+            error_sum += error;
+            error_max = std::max(error_max, error);
+        }
+        points += result.landmarks.size();
+    }
+
+    std::cout << std::left << std::setw(18) << row.name << std::right << std::fixed
+              << std::setprecision(3)
+              << std::setw(12) << (faces > 0 ? time_ms / faces : 0.0)
+              << std::setw(12) << (points > 0 ? error_sum / points : 0.0)
+              << std::setw(12) << error_max << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t max_frames = 100;
+    std::string source;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            source = argv[i];
+        }
+    }
+
+    if (source.empty()) {
+        std::cerr << "usage: cascade_bench [--frames N] source" << std::endl;
+        return 1;
+    }
+
+    FileCaptureSource::Options options;
+    options.paced = false;
+    FileCaptureSource capture(source, options);
+    if (!capture.open()) {
+        std::cerr << "Failed to open " << source << std::endl;
+        return 1;
+    }
+
+    FaceDetector detector;
+    if (!detector.initialize()) {
+        return 1;
+    }
+    detector.setDetectionPool(nullptr);
+
+    std::vector<cv::Mat> frames;
+    CapturedFrame frame;
+    while (frames.size() < max_frames && capture.read(frame)) {
+        frames.push_back(frame.image.clone());
+    }
+
+    // Full cascade reference, run twice so the timed rows start warm
+    std::vector<LandmarkArray> reference(frames.size());
+    size_t faces = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t f = 0; f < frames.size(); ++f) {
+            const auto result = detector.detectFace(frames[f], FaceDetector::LandmarkQuality{});
+            reference[f] = result.success ? result.landmarks : LandmarkArray{};
+            faces += pass == 0 && result.success;
+        }
+    }
+    if (faces == 0) {
+        std::cerr << "No faces found in " << source << std::endl;
+        return 1;
+    }
+
+    std::cout << frames.size() << " frames, " << faces << " with a face" << std::endl
+              << std::left << std::setw(18) << "setting" << std::right
+              << std::setw(12) << "ms/face" << std::setw(12) << "mean px" << std::setw(12) << "max px"
+              << std::endl;
+
+    // Quality presets first, then every cascade depth with all trees
+    std::vector<Row> rows;
+    for (int q = 0; q <= CascadeShapePredictor::kMaxQualityLevel; ++q) {
+        rows.push_back({"quality " + std::to_string(q), detector.landmarkQualityLevel(q)});
+    }
+    for (unsigned long depth = 1; depth <= detector.landmarkCascadeLevels(); ++depth) {
+        FaceDetector::LandmarkQuality quality;
+        quality.cascade_depth = depth;
+        rows.push_back({"depth " + std::to_string(depth), quality});
+    }
+
+    for (const auto& row : rows) {
+        runRow(detector, row, frames, reference);
+    }
+
+    // Warm starts run the full cascade from a later level
+    const unsigned long levels = detector.landmarkCascadeLevels();
+    for (unsigned long start : {levels / 4, levels / 2, (3 * levels) / 4}) {
+        if (start == 0) {
+            continue;
+        }
+        FaceDetector::WarmStart warm_start;
+        warm_start.enabled = true;
+        warm_start.start_level = start;
+        detector.setLandmarkWarmStart(warm_start);
+        runRow(detector, {"warm from " + std::to_string(start), FaceDetector::LandmarkQuality{}}, frames, reference);
+    }
+    detector.setLandmarkWarmStart(FaceDetector::WarmStart{});
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Concurrent detection on shared models against single-threaded results.
+//
+// usage: concurrency_check [--threads N] [--frames N] [--repeat N] source
+//   source: a video file, an image directory or an image pattern.
+//   One detector runs over the frames alone to produce the reference. Then
+//   N detectors sharing the same loaded models run over them at once, each
+//   starting at a different frame, and every result must match the
+//   reference exactly. Exits nonzero on any difference.
+#include "../include/core/file_capture_source.hpp"
+#include "../include/core/face_detector.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace capvision::core;
+
+namespace {
+
+bool sameResult(const FaceDetector::FaceDetectionResult& a, const FaceDetector::FaceDetectionResult& b) {
+    if (a.success != b.success || a.face_rect != b.face_rect || a.landmarks.size() != b.landmarks.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.landmarks.size(); ++i) {
+        if (a.landmarks[i] != b.landmarks[i]) {
+            return false;
+        }
+    }
+    return a.rotation_matrix == b.rotation_matrix;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t thread_count = std::max(2u, std::thread::hardware_concurrency());
+    size_t max_frames = 100;
+    int repeat = 2;
+    std::string source;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            thread_count = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            source = argv[i];
+        }
+    }
+
+    if (source.empty()) {
+        std::cerr << "usage: concurrency_check [--threads N] [--frames N] [--repeat N] source" << std::endl;
+        return 1;
+    }
+
+    FileCaptureSource::Options options;
+    options.paced = false;
+    FileCaptureSource capture(source, options);
+    if (!capture.open()) {
+        std::cerr << "Failed to open " << source << std::endl;
+        return 1;
+    }
+
+    std::vector<cv::Mat> frames;
+    CapturedFrame frame;
+    while (frames.size() < max_frames && capture.read(frame)) {
+        frames.push_back(frame.image.clone());
+    }
+    if (frames.empty()) {
+        std::cerr << "No frames in " << source << std::endl;
+        return 1;
+    }
+
+    // Reference: one detector, one thread
+    FaceDetector reference_detector;
+    if (!reference_detector.initialize()) {
+        return 1;
+    }
+    reference_detector.setDetectionPool(nullptr);
+    std::vector<FaceDetector::FaceDetectionResult> reference;
+    for (const cv::Mat& image : frames) {
+        reference.push_back(reference_detector.detectFace(image));
+    }
+
+    // Workers: own state, the reference detector's models
+    const std::shared_ptr<const FaceModels> models = reference_detector.models();
+    std::vector<std::unique_ptr<FaceDetector>> detectors;
+    for (size_t t = 0; t < thread_count; ++t) {
+        auto detector = std::make_unique<FaceDetector>();
+        detector->setDetectionPool(nullptr);
+        if (!detector->initialize(models)) {
+            return 1;
+        }
+        detectors.push_back(std::move(detector));
+    }
+
+    std::atomic<size_t> checked{0};
+    std::atomic<size_t> mismatches{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            FaceDetector& detector = *detectors[t];
+            for (int pass = 0; pass < repeat; ++pass) {
+                for (size_t n = 0; n < frames.size(); ++n) {
+                    const size_t f = (n + t * frames.size() / thread_count) % frames.size();
+                    if (!sameResult(detector.detectFace(frames[f]), reference[f])) {
+                        ++mismatches;
+                    }
+                    ++checked;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::cout << thread_count << " threads, " << checked << " detections on one "
+              << models->landmarks.memoryBytes() / (1024 * 1024) << " MB landmark model ("
+              << models.use_count() - 1 << " detectors sharing it)" << std::endl;
+    if (mismatches > 0) {
+        std::cout << "FAIL: " << mismatches << " results differ from the single-threaded run" << std::endl;
+        return 1;
+    }
+    std::cout << "OK: every result matches the single-threaded run" << std::endl;
+    return 0;
+}
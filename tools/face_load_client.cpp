@@ -0,0 +1,241 @@
+// Load generator for face_server.
+//
+// usage: face_load_client [--socket PATH | --port N] [--clients N] [--requests N]
+//                         [--depth N] [--deadline MS] [--raw] [--json] image
+//   Each client keeps up to --depth requests in flight on its own connection.
+//   --raw sends the image as gray pixels instead of its encoded file bytes.
+#include "../include/core/face_protocol.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace capvision::core;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    std::string socket_path;
+    uint16_t port{7878};
+    size_t clients{4};
+    size_t requests{200};
+    size_t depth{1};
+    uint32_t deadline_ms{0};
+    bool raw{false};
+    bool json{false};
+};
+
+struct Totals {
+    std::mutex mutex;
+    std::vector<double> latencies_ms;
+    std::array<size_t, 4> status_counts{};
+    size_t failed_connections{0};
+};
+
+int connectToServer(const Options& options) {
+    if (!options.socket_path.empty()) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, options.socket_path.c_str(), sizeof(address.sun_path) - 1);
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        return fd;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    return -1;
+}
+
+void runClient(const Options& options, protocol::RequestHeader header,
+               const std::vector<uint8_t>& payload, Totals& totals) {
+    const int fd = connectToServer(options);
+    if (fd < 0) {
+        std::lock_guard<std::mutex> lock(totals.mutex);
+        ++totals.failed_connections;
+        return;
+    }
+
+    std::vector<Clock::time_point> sent_at(options.requests);
+    std::vector<double> latencies;
+    std::array<size_t, 4> status_counts{};
+    latencies.reserve(options.requests);
+
+    size_t sent = 0;
+    auto sendNext = [&]() {
+        header.request_id = static_cast<uint32_t>(sent);
+        sent_at[sent] = Clock::now();
+        ++sent;
+        return protocol::writeFully(fd, &header, sizeof(header)) &&
+               protocol::writeFully(fd, payload.data(), payload.size());
+    };
+
+    bool ok = true;
+    while (ok && sent < std::min(options.depth, options.requests)) {
+        ok = sendNext();
+    }
+
+    std::vector<uint8_t> result;
+    for (size_t received = 0; ok && received < options.requests; ++received) {
+        protocol::ResponseHeader response;
+        if (!protocol::readFully(fd, &response, sizeof(response)) ||
+            response.magic != protocol::kResponseMagic ||
+            response.request_id >= sent) {
+            ok = false;
+            break;
+        }
+        result.resize(response.payload_size);
+        if (!protocol::readFully(fd, result.data(), result.size())) {
+            ok = false;
+            break;
+        }
+
+        latencies.push_back(std::chrono::duration<double, std::milli>(
+            Clock::now() - sent_at[response.request_id]).count());
+        if (response.status < status_counts.size()) {
+            ++status_counts[response.status];
+        }
+
+        if (sent < options.requests) {
+            ok = sendNext();
+        }
+    }
+    close(fd);
+
+    std::lock_guard<std::mutex> lock(totals.mutex);
+    totals.latencies_ms.insert(totals.latencies_ms.end(), latencies.begin(), latencies.end());
+    for (size_t i = 0; i < status_counts.size(); ++i) {
+        totals.status_counts[i] += status_counts[i];
+    }
+    if (!ok) {
+        ++totals.failed_connections;
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::string image_path;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            options.socket_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--clients") == 0 && i + 1 < argc) {
+            options.clients = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--requests") == 0 && i + 1 < argc) {
+            options.requests = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            options.depth = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--deadline") == 0 && i + 1 < argc) {
+            options.deadline_ms = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--raw") == 0) {
+            options.raw = true;
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        } else {
+            image_path = argv[i];
+        }
+    }
+
+    if (image_path.empty()) {
+        std::cerr << "usage: face_load_client [--socket PATH | --port N] [--clients N] [--requests N] "
+                     "[--depth N] [--deadline MS] [--raw] [--json] image" << std::endl;
+        return 1;
+    }
+
+    protocol::RequestHeader header;
+    header.deadline_ms = options.deadline_ms;
+    header.result_encoding = static_cast<uint16_t>(
+        options.json ? protocol::ResultEncoding::Json : protocol::ResultEncoding::Binary);
+
+    std::vector<uint8_t> payload;
+    if (options.raw) {
+        const cv::Mat gray = cv::imread(image_path, cv::IMREAD_GRAYSCALE);
+        if (gray.empty()) {
+            std::cerr << "Failed to read " << image_path << std::endl;
+            return 1;
+        }
+        payload.assign(gray.data, gray.data + gray.total());
+        header.frame_encoding = static_cast<uint16_t>(protocol::FrameEncoding::Gray);
+        header.width = static_cast<uint32_t>(gray.cols);
+        header.height = static_cast<uint32_t>(gray.rows);
+    } else {
+        std::ifstream file(image_path, std::ios::binary);
+        payload.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (payload.empty()) {
+            std::cerr << "Failed to read " << image_path << std::endl;
+            return 1;
+        }
+        header.frame_encoding = static_cast<uint16_t>(protocol::FrameEncoding::Encoded);
+    }
+    header.payload_size = static_cast<uint32_t>(payload.size());
+
+    Totals totals;
+    const auto start = Clock::now();
+    std::vector<std::thread> clients;
+    for (size_t i = 0; i < options.clients; ++i) {
+        clients.emplace_back(runClient, std::cref(options), header, std::cref(payload), std::ref(totals));
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    auto& latencies = totals.latencies_ms;
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::fixed << std::setprecision(2)
+              << latencies.size() << " responses in " << seconds << " s, "
+              << (seconds > 0.0 ? latencies.size() / seconds : 0.0) << " req/s" << std::endl
+              << "  ok " << totals.status_counts[0]
+              << ", busy " << totals.status_counts[1]
+              << ", deadline exceeded " << totals.status_counts[2]
+              << ", bad request " << totals.status_counts[3]
+              << ", failed connections " << totals.failed_connections << std::endl
+              << "  latency p50 " << percentile(latencies, 0.50)
+              << " / p95 " << percentile(latencies, 0.95)
+              << " / p99 " << percentile(latencies, 0.99)
+              << " / max " << (latencies.empty() ? 0.0 : latencies.back()) << " ms" << std::endl;
+    return totals.failed_connections == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// Local face-analysis server.
+//
+// usage: face_server [--socket PATH | --port N] [--workers N] [--queue N]
+//                    [--batch N] [--window US]
+//   Serves until SIGINT/SIGTERM; see face_protocol.hpp for the wire format
+#include "../include/core/face_server.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+using namespace capvision::core;
+
+namespace {
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void onSignal(int) {
+    stop_requested = 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    FaceServer::Config config;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            config.unix_socket_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            config.tcp_port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            config.worker_count = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+            config.queue_capacity = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            config.max_batch = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            config.batch_window = std::chrono::microseconds(std::atol(argv[++i]));
+        } else {
+            std::cerr << "usage: face_server [--socket PATH | --port N] [--workers N] [--queue N] "
+                         "[--batch N] [--window US]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    FaceServer server(config);
+    if (!server.start()) {
+        std::cerr << "Failed to start the face server" << std::endl;
+        return 1;
+    }
+
+    if (config.unix_socket_path.empty()) {
+        std::cout << "listening on 127.0.0.1:" << config.tcp_port << std::endl;
+    } else {
+        std::cout << "listening on " << config.unix_socket_path << std::endl;
+    }
+
+    while (!stop_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    server.stop();
+    return 0;
+}
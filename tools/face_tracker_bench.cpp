@@ -0,0 +1,113 @@
+// Per-frame cost and ID stability of the multi-face tracker.
+//
+// usage: face_tracker_bench [--frames N] [--scan-interval N] [--refreshes N] source
+//   source: a video file, an image directory or an image pattern.
+//   Runs a FaceTracker over the clip and reports the mean and worst time per
+//   frame split into scan and non-scan frames, the mean number of faces
+//   reported, and how many distinct track IDs were handed out: with the same
+//   people in view throughout, every ID beyond their number is a lost track.
+#include "../include/core/face_tracker.hpp"
+#include "../include/core/file_capture_source.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+
+using namespace capvision::core;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Cost {
+    size_t frames{0};
+    double total_ms{0.0};
+    double max_ms{0.0};
+
+    void add(double ms) {
+        ++frames;
+        total_ms += ms;
+        max_ms = std::max(max_ms, ms);
+    }
+};
+
+void printCost(const char* name, const Cost& cost) {
+    std::cout << std::left << std::setw(12) << name << std::right
+              << std::setw(8) << cost.frames
+              << std::setw(12) << cost.total_ms / std::max<size_t>(1, cost.frames)
+              << std::setw(12) << cost.max_ms << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t max_frames = 1000;
+    FaceTracker::Config config;
+    std::string source;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--scan-interval") == 0 && i + 1 < argc) {
+            config.scan_interval = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--refreshes") == 0 && i + 1 < argc) {
+            config.refreshes_per_frame = std::max(1, std::atoi(argv[++i]));
+        } else {
+            source = argv[i];
+        }
+    }
+
+    if (source.empty()) {
+        std::cerr << "usage: face_tracker_bench [--frames N] [--scan-interval N] [--refreshes N] source"
+                  << std::endl;
+        return 1;
+    }
+
+    FaceDetector detector;
+    if (!detector.initialize()) {
+        return 1;
+    }
+    FaceTracker tracker(config);
+    tracker.initialize(detector.models());
+
+    FileCaptureSource capture(source);
+    if (!capture.open()) {
+        std::cerr << "Failed to open " << source << std::endl;
+        return 1;
+    }
+
+    CapturedFrame frame;
+    cv::Mat bgr;
+    Cost scan;
+    Cost propagate;
+    size_t faces = 0;
+    std::set<int> ids;
+    for (size_t f = 0; f < max_frames && capture.read(frame); ++f) {
+        if (!convertToBgr(frame, bgr)) {
+            return 1;
+        }
+        const auto start = Clock::now();
+        const auto& results = tracker.update(bgr);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        (tracker.scanned() ? scan : propagate).add(ms);
+        faces += results.size();
+        for (const auto& face : results) {
+            ids.insert(face.track_id);
+        }
+    }
+
+    const size_t frames = scan.frames + propagate.frames;
+    std::cout << frames << " frames, " << std::fixed << std::setprecision(2)
+              << static_cast<double>(faces) / std::max<size_t>(1, frames) << " faces per frame, "
+              << ids.size() << " track IDs" << std::endl
+              << std::left << std::setw(12) << "" << std::right
+              << std::setw(8) << "frames" << std::setw(12) << "ms/frame" << std::setw(12) << "worst ms"
+              << std::endl;
+    printCost("scan", scan);
+    printCost("between", propagate);
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Landmark cost and accuracy of the flat forest layout against dlib's.
+//
+// usage: flat_model_bench [--frames N] [--repeat N] source
+//   source: a video file, an image directory or an image pattern.
+//   The same frames go through a detector with dlib's nested forests and one
+//   with the flat layout; landmark time, resident model size and the
+//   landmark difference between the two are reported.
+#include "../include/core/file_capture_source.hpp"
+#include "../include/core/face_detector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace capvision::core;
+
+namespace {
+
+struct Run {
+    double landmarks_ms{0.0};
+    size_t faces{0};
+    std::vector<LandmarkArray> landmarks;
+};
+
+Run runDetector(FaceDetector& detector, const std::vector<cv::Mat>& frames, int repeat) {
+    Run run;
+    run.landmarks.resize(frames.size());
+
+    // First pass warms caches and is not timed
+    for (int pass = 0; pass <= repeat; ++pass) {
+        for (size_t f = 0; f < frames.size(); ++f) {
+            const auto result = detector.detectFace(frames[f]);
+            if (!result.success) {
+                continue;
+            }
+            if (pass == 0) {
+                run.landmarks[f] = result.landmarks;
+                continue;
+            }
+            run.landmarks_ms += detector.lastTimings().landmarks_ms;
+            ++run.faces;
+        }
+    }
+    return run;
+}
+
+void printRow(const std::string& name, const Run& run, size_t bytes) {
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << (run.faces > 0 ? run.landmarks_ms / run.faces : 0.0)
+              << std::setw(12) << std::setprecision(1) << bytes / (1024.0 * 1024.0) << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t max_frames = 100;
+    int repeat = 3;
+    std::string source;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            source = argv[i];
+        }
+    }
+
+    if (source.empty()) {
+        std::cerr << "usage: flat_model_bench [--frames N] [--repeat N] source" << std::endl;
+        return 1;
+    }
+
+    FileCaptureSource::Options options;
+    options.paced = false;
+    FileCaptureSource capture(source, options);
+    if (!capture.open()) {
+        std::cerr << "Failed to open " << source << std::endl;
+        return 1;
+    }
+
+    std::vector<cv::Mat> frames;
+    CapturedFrame frame;
+    while (frames.size() < max_frames && capture.read(frame)) {
+        frames.push_back(frame.image.clone());
+    }
+
+    FaceDetector nested;
+    FaceDetector flat;
+    if (!nested.initialize(false) || !flat.initialize(true)) {
+        return 1;
+    }
+    nested.setDetectionPool(nullptr);
+    flat.setDetectionPool(nullptr);
+
+    const Run nested_run = runDetector(nested, frames, repeat);
+    const Run flat_run = runDetector(flat, frames, repeat);
+    if (nested_run.faces == 0) {
+        std::cerr << "No faces found in " << source << std::endl;
+        return 1;
+    }
+
+    double error_sum = 0.0;
+    double error_max = 0.0;
+    size_t points = 0;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        const auto& a = nested_run.landmarks[f];
+        const auto& b = flat_run.landmarks[f];
+        for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+            const cv::Point2f delta = a[i] - b[i];
+            const double error = std::sqrt(delta.dot(delta));
+            error_sum += error;
+            error_max = std::max(error_max, error);
+            ++points;
+        }
+    }
+
+    std::cout << frames.size() << " frames, " << nested_run.faces / repeat << " with a face" << std::endl
+              << std::left << std::setw(10) << "layout" << std::right
+              << std::setw(12) << "ms/face" << std::setw(12) << "model MB" << std::endl;
+    printRow("nested", nested_run, nested.landmarkModelBytes());
+    printRow("flat", flat_run, flat.landmarkModelBytes());
+    std::cout << std::fixed << std::setprecision(3)
+              << "landmark difference: mean " << (points > 0 ? error_sum / points : 0.0)
+              << " px, max " << error_max << " px" << std::endl;
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Work saved and accuracy lost by gating detection on motion.
+//
+// usage: motion_gate_bench [--frames N] [--threshold F] source
+//   source: a video file, an image directory or an image pattern.
+//   Runs detection on every frame as the reference, then again through a
+//   MotionGate (--threshold overrides the changed-cell fraction), and reports
+//   the share of frames actually detected, the time per frame, frames where
+//   a face is found by only one of the two, and the mean landmark distance
+//   of the gated results from the reference.
+#include "../include/core/file_capture_source.hpp"
+#include "../include/core/motion_gate.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace capvision::core;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Run {
+    std::vector<FaceDetector::FaceDetectionResult> results;
+    size_t detected{0};
+    double total_ms{0.0};
+};
+
+bool runClip(const std::string& source, size_t max_frames, FaceDetector& detector,
+             MotionGate* gate, Run& run) {
+    FileCaptureSource capture(source);
+    if (!capture.open()) {
+        std::cerr << "Failed to open " << source << std::endl;
+        return false;
+    }
+
+    CapturedFrame frame;
+    cv::Mat bgr;
+    FaceDetector::FaceDetectionResult last;
+    while (run.results.size() < max_frames && capture.read(frame)) {
+        if (!convertToBgr(frame, bgr)) {
+            return false;
+        }
+        const auto start = Clock::now();
+        if (!gate || gate->check(bgr, frame.timestamp_us)) {
+            last = detector.detectFace(bgr);
+            if (gate) {
+                gate->update(last, frame.timestamp_us);
+            }
+            ++run.detected;
+        }
+        run.total_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        run.results.push_back(last);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t max_frames = 1000;
+    MotionGate::Config config;
+    std::string source;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            config.changed_fraction = std::atof(argv[++i]);
+        } else {
+            source = argv[i];
+        }
+    }
+
+    if (source.empty()) {
+        std::cerr << "usage: motion_gate_bench [--frames N] [--threshold F] source" << std::endl;
+        return 1;
+    }
+
+    FaceDetector detector;
+    if (!detector.initialize()) {
+        return 1;
+    }
+
+    Run reference;
+    if (!runClip(source, max_frames, detector, nullptr, reference)) {
+        return 1;
+    }
+    MotionGate gate(config);
+    Run gated;
+    if (!runClip(source, max_frames, detector, &gate, gated)) {
+        return 1;
+    }
+
+    size_t mismatched = 0;
+    size_t compared = 0;
+    double landmark_px = 0.0;
+    const size_t frames = std::min(reference.results.size(), gated.results.size());
+    for (size_t f = 0; f < frames; ++f) {
+        const auto& a = reference.results[f];
+        const auto& b = gated.results[f];
+        if (a.success != b.success) {
+            ++mismatched;
+        } else if (a.success && a.landmarks.size() == b.landmarks.size() && !a.landmarks.empty()) {
+            double px = 0.0;
+            for (size_t i = 0; i < a.landmarks.size(); ++i) {
+                px += cv::norm(a.landmarks[i] - b.landmarks[i]);
+            }
+            landmark_px += px / a.landmarks.size();
+            ++compared;
+        }
+    }
+
+    const double n = std::max<size_t>(1, frames);
+    std::cout << frames << " frames" << std::endl
+              << std::left << std::setw(12) << "" << std::right
+              << std::setw(12) << "detected" << std::setw(12) << "ms/frame" << std::endl
+              << std::fixed << std::setprecision(2)
+              << std::left << std::setw(12) << "every frame" << std::right
+              << std::setw(11) << 100.0 * reference.detected / n << "%"
+              << std::setw(12) << reference.total_ms / n << std::endl
+              << std::left << std::setw(12) << "gated" << std::right
+              << std::setw(11) << 100.0 * gated.detected / n << "%"
+              << std::setw(12) << gated.total_ms / n << std::endl
+              << "face found by only one: " << mismatched << " frames, mean landmark distance "
+              << landmark_px / std::max<size_t>(1, compared) << " px" << std::endl;
+    return 0;
+}
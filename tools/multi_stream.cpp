@@ -0,0 +1,92 @@
+// Headless multi-stream face detection on a shared worker pool.
+//
+// usage: multi_stream [--workers N] [--budget MS] [--seconds S] source...
+//   source: a camera index ("0"), a video file, an image directory or an
+//           image pattern; files are played back in real time and looped
+#include "../include/core/file_capture_source.hpp"
+#include "../include/core/stream_engine.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace capvision::core;
+
+namespace {
+
+bool isCameraIndex(const std::string& source) {
+    return !source.empty() && source.find_first_not_of("0123456789") == std::string::npos;
+}
+
+void printStats(const StreamEngine& engine) {
+    std::cout << std::fixed << std::setprecision(1)
+              << "aggregate " << engine.throughputFps() << " fps" << std::endl;
+    for (size_t i = 0; i < engine.streamCount(); ++i) {
+        const auto stats = engine.stats(i);
+        std::cout << "  stream " << i
+                  << ": captured " << stats.frames_captured
+                  << ", processed " << stats.frames_processed
+                  << ", dropped " << stats.frames_dropped
+                  << ", latency mean " << stats.mean_latency_ms
+                  << " / p50 " << stats.p50_latency_ms
+                  << " / p95 " << stats.p95_latency_ms
+                  << " / max " << stats.max_latency_ms << " ms" << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    StreamEngine::Config config;
+    double seconds = 10.0;
+    std::vector<std::string> sources;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            config.worker_count = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            config.latency_budget_ms = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = std::atof(argv[++i]);
+        } else {
+            sources.push_back(argv[i]);
+        }
+    }
+
+    if (sources.empty()) {
+        std::cerr << "usage: multi_stream [--workers N] [--budget MS] [--seconds S] source..." << std::endl;
+        return 1;
+    }
+
+    StreamEngine engine(config);
+    for (const auto& source : sources) {
+        std::unique_ptr<CaptureSource> capture;
+        if (isCameraIndex(source)) {
+            capture = createCameraSource(std::atoi(source.c_str()));
+        } else {
+            FileCaptureSource::Options options;
+            options.loop = true;
+            options.paced = true;
+            capture = std::make_unique<FileCaptureSource>(source, options);
+        }
+        engine.addStream(std::move(capture), nullptr);
+    }
+
+    if (!engine.start()) {
+        std::cerr << "Failed to start the stream engine" << std::endl;
+        return 1;
+    }
+
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        printStats(engine);
+    }
+
+    engine.stop();
+    return 0;
+}
@@ -0,0 +1,121 @@
+// Pose prediction error over a recording, for tuning PosePredictor.
+//
+// usage: pose_predict_bench [--stride N] recording.cvr
+//   Feeds every Nth recorded detection to the predictor, as if detection
+//   ran at 1/N of the frame rate, and predicts the pose at the timestamps of
+//   the frames in between and of the next fed one. Reports the mean landmark
+//   and rotation error against the recorded results, for holding the last
+//   detection and for a few filter settings.
+#include "../include/core/pose_predictor.hpp"
+#include "../include/core/result_recording.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace capvision::core;
+
+namespace {
+
+struct Error {
+    double landmark_px{0.0};
+    double rotation_deg{0.0};
+    size_t samples{0};
+
+    void add(const FaceDetector::FaceDetectionResult& predicted, const FaceDetector::FaceDetectionResult& actual) {
+        const size_t count = std::min(predicted.landmarks.size(), actual.landmarks.size());
+        if (count == 0) {
+            return;
+        }
+        double px = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            px += cv::norm(predicted.landmarks[i] - actual.landmarks[i]);
+        }
+        const cv::Matx33d relative = predicted.rotation_matrix.t() * actual.rotation_matrix;
+        const double cos_angle = (relative(0, 0) + relative(1, 1) + relative(2, 2) - 1.0) / 2.0;
+        landmark_px += px / count;
+        rotation_deg += std::acos(std::max(-1.0, std::min(1.0, cos_angle))) * (180.0 / CV_PI);
+        ++samples;
+    }
+};
+
+// hold: no filtering, the last detection stands until the next one
+Error run(const std::vector<RecordedFrame>& frames, size_t stride, const PosePredictor::Config* config) {
+    PosePredictor predictor(config ? *config : PosePredictor::Config{});
+    FaceDetector::FaceDetectionResult last;
+    Error error;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        const RecordedFrame& frame = frames[f];
+        const bool fed = f % stride == 0;
+        if (frame.result.success && (last.success || predictor.hasFace())) {
+            // Measured before the detection is fed, as the display would see it
+            error.add(config ? predictor.predict(frame.timestamp_us) : last, frame.result);
+        }
+        if (fed) {
+            predictor.update(frame.result, frame.timestamp_us);
+            last = frame.result;
+        }
+    }
+    return error;
+}
+
+void printRow(const std::string& name, const Error& error) {
+    const double n = std::max<size_t>(1, error.samples);
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << error.landmark_px / n << std::setw(12) << error.rotation_deg / n << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t stride = 1;
+    std::string path;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stride") == 0 && i + 1 < argc) {
+            stride = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (path.empty()) {
+        std::cerr << "usage: pose_predict_bench [--stride N] recording.cvr" << std::endl;
+        return 1;
+    }
+
+    ResultReplay replay;
+    if (!replay.open(path)) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return 1;
+    }
+    std::vector<RecordedFrame> frames;
+    RecordedFrame frame;
+    while (replay.next(frame)) {
+        frames.push_back(frame);
+    }
+
+    PosePredictor::Config defaults;
+    PosePredictor::Config steady = defaults;
+    steady.landmarks.min_cutoff_hz = 0.5;
+    steady.rotation.min_cutoff_hz = 0.5;
+    PosePredictor::Config responsive = defaults;
+    responsive.landmarks.beta *= 4.0;
+    responsive.rotation.beta *= 4.0;
+    PosePredictor::Config no_extrapolation = defaults;
+    no_extrapolation.max_horizon_ms = 0.0;
+
+    std::cout << frames.size() << " frames, detection on 1 in " << stride << std::endl
+              << std::left << std::setw(28) << "predictor" << std::right
+              << std::setw(12) << "px" << std::setw(12) << "deg" << std::endl;
+    printRow("hold last detection", run(frames, stride, nullptr));
+    printRow("filter only", run(frames, stride, &no_extrapolation));
+    printRow("one-euro default", run(frames, stride, &defaults));
+    printRow("one-euro steady", run(frames, stride, &steady));
+    printRow("one-euro responsive", run(frames, stride, &responsive));
+    return 0;
+}
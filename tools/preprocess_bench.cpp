@@ -0,0 +1,106 @@
+// Microbenchmark: the original assign_image colour copy against the fused
+// grayscale pyramid used by FaceDetector.
+//
+// usage: preprocess_bench [image] [iterations]
+#include "../include/core/gray_conversion.hpp"
+#include "../include/core/gray_pyramid.hpp"
+#include <dlib/image_processing/frontal_face_detector.h>
+#include <dlib/opencv.h>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+double timeIt(int iterations, const std::function<void()>& body) {
+    body();  // warm up caches and allocations
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        body();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+}
+
+void report(const char* name, double ms, double baseline_ms) {
+    std::cout << std::left << std::setw(44) << name
+              << std::right << std::fixed << std::setprecision(3) << std::setw(9) << ms << " ms"
+              << std::setprecision(2) << std::setw(8) << baseline_ms / ms << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    cv::Mat frame;
+    if (argc > 1) {
+        frame = cv::imread(argv[1], cv::IMREAD_COLOR);
+        if (frame.empty()) {
+            std::cerr << "Failed to read " << argv[1] << std::endl;
+            return 1;
+        }
+    } else {
+        frame.create(480, 640, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    }
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    // Same level count the detector scans for this frame size
+    dlib::frontal_face_detector detector = dlib::get_frontal_face_detector();
+    unsigned long num_levels = 0;
+    {
+        dlib::pyramid_down<6> pyr;
+        dlib::rectangle rect(frame.cols, frame.rows);
+        const auto& scanner = detector.get_scanner();
+        do {
+            rect = pyr.rect_down(rect);
+            ++num_levels;
+        } while (rect.width() >= scanner.get_min_pyramid_layer_width() &&
+                 rect.height() >= scanner.get_min_pyramid_layer_height());
+    }
+
+    std::cout << frame.cols << "x" << frame.rows << ", " << num_levels << " pyramid levels, "
+              << iterations << " iterations, AVX2 " << (capvision::core::avx2Available() ? "on" : "off")
+              << std::endl;
+
+    dlib::matrix<dlib::rgb_pixel> rgb;
+    const double assign_ms = timeIt(iterations, [&] {
+        dlib::assign_image(rgb, dlib::cv_image<dlib::bgr_pixel>(frame));
+    });
+
+    std::vector<dlib::array2d<dlib::rgb_pixel>> rgb_levels(num_levels);
+    const double assign_pyramid_ms = timeIt(iterations, [&] {
+        dlib::assign_image(rgb, dlib::cv_image<dlib::bgr_pixel>(frame));
+        dlib::pyramid_down<6> pyr;
+        pyr(rgb, rgb_levels[1]);
+        for (unsigned long l = 2; l < num_levels; ++l) {
+            pyr(rgb_levels[l - 1], rgb_levels[l]);
+        }
+    });
+
+    cv::Mat gray(frame.rows, frame.cols, CV_8UC1);
+    const double scalar_ms = timeIt(iterations, [&] {
+        for (int y = 0; y < frame.rows; ++y) {
+            capvision::core::bgrToGrayRowScalar(frame.ptr<unsigned char>(y), gray.ptr<unsigned char>(y), frame.cols);
+        }
+    });
+
+    const double dispatched_ms = timeIt(iterations, [&] {
+        for (int y = 0; y < frame.rows; ++y) {
+            capvision::core::bgrToGrayRow(frame.ptr<unsigned char>(y), gray.ptr<unsigned char>(y), frame.cols);
+        }
+    });
+
+    capvision::core::GrayPyramid pyramid;
+    const double pyramid_ms = timeIt(iterations, [&] {
+        pyramid.build(frame, num_levels);
+    });
+
+    report("assign_image (BGR -> rgb_pixel copy)", assign_ms, assign_ms);
+    report("assign_image + rgb pyramid", assign_pyramid_ms, assign_ms);
+    report("gray row kernel, scalar", scalar_ms, assign_ms);
+    report("gray row kernel, dispatched", dispatched_ms, assign_ms);
+    report("GrayPyramid::build (fused gray pyramid)", pyramid_ms, assign_pyramid_ms);
+    return 0;
+}
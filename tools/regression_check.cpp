@@ -0,0 +1,292 @@
+// Accuracy and latency regression check of the detect -> pose pipeline.
+//
+// usage: regression_check [--update] [--slack F] [--no-latency] [--threads N] DIR
+//   DIR/clips.txt             one clip per line (video, image directory or
+//                             pattern), relative to DIR; '#' starts a comment
+//   DIR/golden/<clip>.cvr     expected results per clip (result_recording.hpp)
+//   DIR/latency_baseline.txt  "<stage> <p50 ms>" per pipeline stage
+//
+// Runs headless over every clip and compares landmarks, Euler angles and
+// detections against the goldens, then the p50 time of each FaceDetector
+// stage against the baseline (slower than baseline * (1 + slack) fails).
+// --update rewrites the goldens and the baseline from this run instead.
+// Exits 0 when everything passes, 1 on a regression, 2 on a setup error.
+#include "../include/core/file_capture_source.hpp"
+#include "../include/core/result_recording.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace capvision::core;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Tolerances {
+    double landmark_mean_px{0.75};
+    double landmark_max_px{4.0};
+    double euler_deg{2.0};
+    double detection_mismatch{0.02};   // Fraction of frames
+    double latency_slack{0.25};
+    double latency_floor_ms{0.2};      // Ignore differences below timer noise
+};
+
+constexpr size_t kWarmupFrames = 3;
+const std::array<const char*, 4> kStages{"pyramid", "detection", "landmarks", "pose"};
+
+std::array<double, 4> stageValues(const FaceDetector::StageTimings& timings) {
+    return {timings.pyramid_ms, timings.detection_ms, timings.landmarks_ms, timings.pose_ms};
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+std::vector<std::string> readClipList(const fs::path& dir) {
+    std::vector<std::string> clips;
+    std::ifstream file(dir / "clips.txt");
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty()) {
+            clips.push_back(line);
+        }
+    }
+    return clips;
+}
+
+std::map<std::string, double> readBaseline(const fs::path& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string stage;
+    double ms;
+    while (file >> stage >> ms) {
+        baseline[stage] = ms;
+    }
+    return baseline;
+}
+
+struct ClipRun {
+    std::vector<RecordedFrame> frames;
+};
+
+bool runClip(const fs::path& clip, FaceDetector& detector, ClipRun& run,
+             std::array<std::vector<double>, 4>& stageSamples) {
+    FileCaptureSource::Options options;
+    options.paced = false;
+    FileCaptureSource capture(clip.string(), options);
+    if (!capture.open()) {
+        std::cerr << "cannot open clip " << clip << std::endl;
+        return false;
+    }
+
+    CapturedFrame frame;
+    while (capture.read(frame)) {
+        RecordedFrame recorded;
+        recorded.timestamp_us = frame.timestamp_us;
+        recorded.index = run.frames.size();
+        recorded.result = detector.detectFace(frame.image);
+
+        if (run.frames.size() >= kWarmupFrames) {
+            const auto values = stageValues(detector.lastTimings());
+            for (size_t s = 0; s < values.size(); ++s) {
+                if (values[s] > 0.0) {
+                    stageSamples[s].push_back(values[s]);
+                }
+            }
+        }
+        run.frames.push_back(std::move(recorded));
+    }
+    return !run.frames.empty();
+}
+
+bool writeGolden(const fs::path& path, const ClipRun& run, int width, int height) {
+    fs::create_directories(path.parent_path());
+    ResultRecorder recorder;
+    ResultRecorder::Options options;
+    options.frame_width = width;
+    options.frame_height = height;
+    if (!recorder.open(path.string(), options)) {
+        return false;
+    }
+    for (const auto& frame : run.frames) {
+        recorder.append(frame.timestamp_us, frame.result);
+    }
+    return recorder.close();
+}
+
+// Compare one clip against its golden; prints a line and returns pass/fail
+bool compareGolden(const std::string& name, const fs::path& path, const ClipRun& run,
+                   const Tolerances& tolerances) {
+    ResultReplay golden;
+    if (!golden.open(path.string())) {
+        std::cout << "FAIL " << name << ": no golden at " << path << std::endl;
+        return false;
+    }
+    if (golden.frameCount() != run.frames.size()) {
+        std::cout << "FAIL " << name << ": " << run.frames.size() << " frames, golden has "
+                  << golden.frameCount() << std::endl;
+        return false;
+    }
+
+    size_t mismatches = 0;
+    size_t compared_points = 0;
+    double error_sum = 0.0;
+    double error_max = 0.0;
+    double euler_max = 0.0;
+
+    RecordedFrame expected;
+    for (const auto& frame : run.frames) {
+        golden.next(expected);
+        const auto& actual = frame.result;
+        if (actual.success != expected.result.success ||
+            actual.landmarks.size() != expected.result.landmarks.size()) {
+            ++mismatches;
+            continue;
+        }
+        if (!actual.success) {
+            continue;
+        }
+
+        for (size_t i = 0; i < actual.landmarks.size(); ++i) {
+            const cv::Point2f delta = actual.landmarks[i] - expected.result.landmarks[i];
+            const double error = std::sqrt(delta.dot(delta));
+            error_sum += error;
+            error_max = std::max(error_max, error);
+        }
+        compared_points += actual.landmarks.size();
+        for (int i = 0; i < 3; ++i) {
+            euler_max = std::max(euler_max, std::abs(actual.euler_angles[i] - expected.result.euler_angles[i]));
+        }
+    }
+
+    const double error_mean = compared_points > 0 ? error_sum / compared_points : 0.0;
+    const double mismatch_rate = static_cast<double>(mismatches) / run.frames.size();
+    const bool pass = mismatch_rate <= tolerances.detection_mismatch &&
+                      error_mean <= tolerances.landmark_mean_px &&
+                      error_max <= tolerances.landmark_max_px &&
+                      euler_max <= tolerances.euler_deg;
+
+    std::cout << (pass ? "PASS " : "FAIL ") << name << std::fixed << std::setprecision(3)
+              << ": detection mismatches " << mismatches << "/" << run.frames.size()
+              << ", landmark error mean " << error_mean << " px (<= " << tolerances.landmark_mean_px << ")"
+              << " max " << error_max << " px (<= " << tolerances.landmark_max_px << ")"
+              << ", Euler max " << euler_max << " deg (<= " << tolerances.euler_deg << ")" << std::endl;
+    return pass;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Tolerances tolerances;
+    bool update = false;
+    bool check_latency = true;
+    size_t threads = 0;
+    std::string dir_arg;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (std::strcmp(argv[i], "--slack") == 0 && i + 1 < argc) {
+            tolerances.latency_slack = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-latency") == 0) {
+            check_latency = false;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            dir_arg = argv[i];
+        }
+    }
+
+    if (dir_arg.empty()) {
+        std::cerr << "usage: regression_check [--update] [--slack F] [--no-latency] [--threads N] DIR" << std::endl;
+        return 2;
+    }
+
+    const fs::path dir(dir_arg);
+    const auto clips = readClipList(dir);
+    if (clips.empty()) {
+        std::cerr << "no clips listed in " << (dir / "clips.txt") << std::endl;
+        return 2;
+    }
+
+    FaceDetector detector;
+    if (!detector.initialize()) {
+        return 2;
+    }
+    // Serial by default so stage times do not depend on the machine's core count
+    detector.setDetectionPool(threads > 1 ? std::make_shared<ThreadPool>(threads - 1) : nullptr);
+
+    bool pass = true;
+    std::array<std::vector<double>, 4> stage_samples;
+
+    for (const auto& clip : clips) {
+        const fs::path clip_path = dir / clip;
+        const fs::path golden_path = dir / "golden" / (fs::path(clip).stem().string() + ".cvr");
+
+        ClipRun run;
+        if (!runClip(clip_path, detector, run, stage_samples)) {
+            return 2;
+        }
+
+        if (update) {
+            const auto& pyramid = detector.pyramid();
+            const int width = pyramid.size() > 0 ? static_cast<int>(pyramid.level(0).nc()) : 0;
+            const int height = pyramid.size() > 0 ? static_cast<int>(pyramid.level(0).nr()) : 0;
+            if (!writeGolden(golden_path, run, width, height)) {
+                return 2;
+            }
+            std::cout << "updated " << golden_path << " (" << run.frames.size() << " frames)" << std::endl;
+        } else {
+            pass = compareGolden(clip, golden_path, run, tolerances) && pass;
+        }
+    }
+
+    const fs::path baseline_path = dir / "latency_baseline.txt";
+    if (update) {
+        std::ofstream baseline(baseline_path);
+        baseline << std::fixed << std::setprecision(3);
+        for (size_t s = 0; s < kStages.size(); ++s) {
+            baseline << kStages[s] << " " << median(stage_samples[s]) << "\n";
+        }
+        std::cout << "updated " << baseline_path << std::endl;
+        return baseline.good() ? 0 : 2;
+    }
+
+    if (check_latency) {
+        const auto baseline = readBaseline(baseline_path);
+        for (size_t s = 0; s < kStages.size(); ++s) {
+            const auto entry = baseline.find(kStages[s]);
+            if (entry == baseline.end() || stage_samples[s].empty()) {
+                continue;
+            }
+            const double measured = median(stage_samples[s]);
+            const double limit = std::max(entry->second * (1.0 + tolerances.latency_slack),
+                                          entry->second + tolerances.latency_floor_ms);
+            const bool stage_pass = measured <= limit;
+            pass = pass && stage_pass;
+            std::cout << (stage_pass ? "PASS " : "FAIL ") << "latency " << kStages[s]
+                      << std::fixed << std::setprecision(3)
+                      << ": p50 " << measured << " ms, baseline " << entry->second
+                      << " ms, limit " << limit << " ms" << std::endl;
+        }
+    }
+
+    std::cout << (pass ? "regression check passed" : "REGRESSION DETECTED") << std::endl;
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+// Record, synthesize and benchmark .cvr detection-result recordings.
+//
+// usage: result_replay record SOURCE OUT.cvr [--frames N]
+//          Run FaceDetector over a video/image source and record the results
+//        result_replay synth OUT.cvr [--minutes M]
+//          Write M minutes (default 60) of a moving synthetic face at 30 fps
+//        result_replay bench FILE.cvr
+//          Decode the whole recording, then seek around it, and report speed
+#include "../include/core/file_capture_source.hpp"
+#include "../include/core/result_recording.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace capvision::core;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+int record(const std::string& source, const std::string& output, uint64_t maxFrames) {
+    FileCaptureSource::Options options;
+    options.paced = false;
+    FileCaptureSource capture(source, options);
+    if (!capture.open()) {
+        std::cerr << "Failed to open " << source << std::endl;
+        return 1;
+    }
+
+    FaceDetector detector;
+    if (!detector.initialize()) {
+        return 1;
+    }
+
+    ResultRecorder recorder;
+    CapturedFrame frame;
+    while ((maxFrames == 0 || recorder.frameCount() < maxFrames) && capture.read(frame)) {
+        const auto result = detector.detectFace(frame.image);
+        if (!recorder.isOpen()) {
+            ResultRecorder::Options recordOptions;
+            recordOptions.frame_width = frame.image.cols;
+            recordOptions.frame_height = frame.image.rows;
+            if (!recorder.open(output, recordOptions)) {
+                return 1;
+            }
+        }
+        recorder.append(frame.timestamp_us, result);
+    }
+
+    const uint64_t frames = recorder.frameCount();
+    if (!recorder.close()) {
+        return 1;
+    }
+    std::cout << "recorded " << frames << " frames to " << output << std::endl;
+    return 0;
+}
+
+int synthesize(const std::string& output, double minutes) {
+    ResultRecorder recorder;
+    ResultRecorder::Options options;
+    options.frame_width = 640;
+    options.frame_height = 480;
+    if (!recorder.open(output, options)) {
+        return 1;
+    }
+
+    const uint64_t frames = static_cast<uint64_t>(minutes * 60.0 * 30.0);
+    FaceDetector::FaceDetectionResult result;
+    result.success = true;
+    result.landmarks.resize(68);
+    result.rotation_matrix = cv::Matx33d::eye();
+
+    for (uint64_t i = 0; i < frames; ++i) {
+        // A face drifting and nodding slowly, with a little landmark jitter
+        const double t = i / 30.0;
+        const float cx = static_cast<float>(320.0 + 40.0 * std::sin(t * 0.5));
+        const float cy = static_cast<float>(240.0 + 20.0 * std::cos(t * 0.3));
+        result.face_rect = cv::Rect(static_cast<int>(cx) - 90, static_cast<int>(cy) - 90, 180, 180);
+        for (int k = 0; k < 68; ++k) {
+            const double angle = k * 2.0 * CV_PI / 68.0;
+            const float jitter = static_cast<float>(0.3 * std::sin(i * 1.7 + k));
+            result.landmarks[k] = cv::Point2f(cx + 70.0f * static_cast<float>(std::cos(angle)) + jitter,
+                                              cy + 80.0f * static_cast<float>(std::sin(angle)) - jitter);
+        }
+        result.euler_angles = cv::Vec3d(10.0 * std::sin(t), 20.0 * std::sin(t * 0.7), 5.0 * std::cos(t));
+        cv::Rodrigues(cv::Vec3d(result.euler_angles[0], result.euler_angles[1], result.euler_angles[2]) *
+                      (CV_PI / 180.0), result.rotation_matrix);
+
+        recorder.append(static_cast<int64_t>(i * 1000000 / 30), result);
+    }
+
+    if (!recorder.close()) {
+        return 1;
+    }
+    std::cout << "wrote " << frames << " synthetic frames to " << output << std::endl;
+    return 0;
+}
+
+int bench(const std::string& path) {
+    const auto open_start = Clock::now();
+    ResultReplay replay;
+    if (!replay.open(path)) {
+        return 1;
+    }
+    const double open_ms = std::chrono::duration<double, std::milli>(Clock::now() - open_start).count();
+
+    RecordedFrame frame;
+    uint64_t faces = 0;
+    int64_t last_timestamp = replay.firstTimestampUs();
+    const auto decode_start = Clock::now();
+    while (replay.next(frame)) {
+        faces += frame.result.success;
+        last_timestamp = frame.timestamp_us;
+    }
+    const double decode_s = std::chrono::duration<double>(Clock::now() - decode_start).count();
+
+    // Random access: seek to 1000 spread-out frames and decode one each
+    const uint64_t seeks = replay.frameCount() > 0 ? 1000 : 0;
+    const auto seek_start = Clock::now();
+    for (uint64_t i = 0; i < seeks; ++i) {
+        replay.seek((i * 7919) % replay.frameCount());
+        replay.next(frame);
+    }
+    const double seek_us = seeks > 0
+        ? std::chrono::duration<double, std::micro>(Clock::now() - seek_start).count() / seeks : 0.0;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    const double file_bytes = static_cast<double>(file.tellg());
+    const double session_s = (last_timestamp - replay.firstTimestampUs()) / 1e6;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << replay.frameCount() << " frames (" << faces << " with a face), "
+              << session_s / 60.0 << " min of session, "
+              << (replay.frameCount() > 0 ? file_bytes / replay.frameCount() : 0.0) << " bytes/frame" << std::endl
+              << "  open " << open_ms << " ms, decode " << decode_s << " s ("
+              << (decode_s > 0.0 ? replay.frameCount() / decode_s / 1e6 : 0.0) << " M frames/s, "
+              << (decode_s > 0.0 ? session_s / decode_s : 0.0) << "x real time)" << std::endl
+              << "  seek + decode " << seek_us << " us" << std::endl;
+    return 0;
+}
+
+void usage() {
+    std::cerr << "usage: result_replay record SOURCE OUT.cvr [--frames N]\n"
+                 "       result_replay synth OUT.cvr [--minutes M]\n"
+                 "       result_replay bench FILE.cvr" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+
+    const std::string command = argv[1];
+    if (command == "record" && argc >= 4) {
+        uint64_t frames = 0;
+        if (argc >= 6 && std::strcmp(argv[4], "--frames") == 0) {
+            frames = std::strtoull(argv[5], nullptr, 10);
+        }
+        return record(argv[2], argv[3], frames);
+    }
+    if (command == "synth") {
+        double minutes = 60.0;
+        if (argc >= 5 && std::strcmp(argv[3], "--minutes") == 0) {
+            minutes = std::atof(argv[4]);
+        }
+        return synthesize(argv[2], minutes);
+    }
+    if (command == "bench") {
+        return bench(argv[2]);
+    }
+
+    usage();
+    return 1;
+}
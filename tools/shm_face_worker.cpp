@@ -0,0 +1,77 @@
+// Face detection on frames from a shared-memory ring, read in place.
+//
+// usage: shm_face_worker [--name NAME] [--all]
+//   Attaches to the ring NAME (default /capvision), runs FaceDetector on each
+//   frame without copying it and writes results back to the producer.
+//   --all processes every frame in order instead of only the newest one.
+//   Runs until SIGINT/SIGTERM.
+#include "../include/core/shm_capture_source.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace capvision::core;
+
+namespace {
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void onSignal(int) {
+    stop_requested = 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string name = "/capvision";
+    ShmCaptureSource::Options options;
+    options.timeout_ms = 200;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (std::strcmp(argv[i], "--all") == 0) {
+            options.newest_only = false;
+        } else {
+            std::cerr << "usage: shm_face_worker [--name NAME] [--all]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    FaceDetector detector;
+    if (!detector.initialize()) {
+        std::cerr << "Failed to initialize the face detector" << std::endl;
+        return 1;
+    }
+
+    ShmCaptureSource source(name, options);
+    while (!stop_requested && !source.open()) {
+        // Producer not up yet
+    }
+
+    CapturedFrame frame;
+    uint64_t processed = 0;
+    auto next_report = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+    while (!stop_requested) {
+        if (source.read(frame)) {
+            const auto result = detector.detectFace(frame.image);
+            source.publishResult(frame, result);
+            ++processed;
+        }
+
+        if (std::chrono::steady_clock::now() >= next_report) {
+            next_report += std::chrono::seconds(1);
+            std::cout << "processed " << processed << " fps, results dropped "
+                      << (source.ring() ? source.ring()->resultsDropped() : 0) << std::endl;
+            processed = 0;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Bundled producer for the shared-memory frame ring.
+//
+// usage: shm_producer [--name NAME] [--slots N] [--seconds S] source
+//   source: a camera index ("0"), a video file, an image directory or an
+//           image pattern. Frames are written into the ring NAME (default
+//           /capvision); start shm_face_worker (or CapVision --shm NAME) to
+//           consume them. Reports drops and end-to-end result latency.
+#include "../include/core/file_capture_source.hpp"
+#include "../include/core/shared_frame_ring.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace capvision::core;
+
+namespace {
+
+bool isCameraIndex(const std::string& source) {
+    return !source.empty() && source.find_first_not_of("0123456789") == std::string::npos;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string name = "/capvision";
+    SharedFrameRing::Layout layout;
+    double seconds = 10.0;
+    std::string source;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (std::strcmp(argv[i], "--slots") == 0 && i + 1 < argc) {
+            layout.slot_count = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = std::atof(argv[++i]);
+        } else {
+            source = argv[i];
+        }
+    }
+
+    if (source.empty()) {
+        std::cerr << "usage: shm_producer [--name NAME] [--slots N] [--seconds S] source" << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<CaptureSource> capture;
+    if (isCameraIndex(source)) {
+        capture = createCameraSource(std::atoi(source.c_str()));
+    } else {
+        FileCaptureSource::Options options;
+        options.loop = true;
+        options.paced = true;
+        capture = std::make_unique<FileCaptureSource>(source, options);
+        capture->open();
+    }
+    if (!capture->isOpened()) {
+        std::cerr << "Failed to open " << source << std::endl;
+        return 1;
+    }
+
+    auto ring = SharedFrameRing::create(name, layout);
+    if (!ring) {
+        return 1;
+    }
+
+    CapturedFrame frame;
+    cv::Mat bgr;
+    uint64_t written = 0;
+    uint64_t results = 0;
+    uint64_t faces = 0;
+    std::vector<double> latencies_ms;
+    SharedFrameRing::ResultRecord record;
+
+    const auto start = std::chrono::steady_clock::now();
+    auto next_report = start + std::chrono::seconds(1);
+    const auto end = start + std::chrono::duration<double>(seconds);
+
+    while (std::chrono::steady_clock::now() < end && capture->read(frame)) {
+        // The consumer reads BGR, YUYV or gray in place; decode JPEG here
+        CapturedFrame raw = frame;
+        if (frame.format == PixelFormat::MJPEG) {
+            if (!convertToBgr(frame, bgr)) {
+                continue;
+            }
+            raw.image = bgr;
+            raw.format = PixelFormat::BGR;
+        }
+
+        if (uint8_t* slot = ring->beginFrame()) {
+            // The only copy on the path: into the slot the consumer reads in place
+            const size_t row_bytes = raw.image.cols * raw.image.elemSize();
+            if (row_bytes * raw.image.rows <= layout.slot_capacity) {
+                for (int y = 0; y < raw.image.rows; ++y) {
+                    std::memcpy(slot + y * row_bytes, raw.image.ptr(y), row_bytes);
+                }
+                if (ring->commitFrame(raw.image.cols, raw.image.rows, row_bytes, raw.format,
+                                      raw.timestamp_us, raw.sequence)) {
+                    ++written;
+                }
+            }
+        }
+
+        while (ring->readResult(record)) {
+            ++results;
+            faces += record.success;
+            latencies_ms.push_back((steadyNowMicros() - record.timestamp_us) / 1000.0);
+        }
+
+        if (std::chrono::steady_clock::now() >= next_report) {
+            next_report += std::chrono::seconds(1);
+            std::cout << std::fixed << std::setprecision(1)
+                      << "written " << written
+                      << ", dropped " << ring->framesDropped()
+                      << ", results " << results << " (" << faces << " with a face)"
+                      << ", latency p50 " << percentile(latencies_ms, 0.50)
+                      << " / p95 " << percentile(latencies_ms, 0.95) << " ms" << std::endl;
+            latencies_ms.clear();
+        }
+    }
+
+    return 0;
+}